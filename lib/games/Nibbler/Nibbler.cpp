@@ -1,62 +1,281 @@
 #include "Nibbler.hpp"
 #include <cstdlib>
-#include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 #include "../../../src/interfaces/MapLoader.hpp"
+#include "../../../src/interfaces/Snapshot.hpp"
 
 namespace arcade {
 
 Nibbler::Nibbler()
-    : _state(GameState::MENU), _score(0), _level(1), _cellSize(20),
-      _gridWidth(30), _gridHeight(20), _timeAccumulator(0.0f), _moveInterval(0.15f) {
-    srand(time(nullptr));
+    : _growth(0), _state(GameState::MENU), _score(0), _level(1), _cellSize(20),
+      _gridWidth(DEFAULT_GRID_WIDTH), _gridHeight(DEFAULT_GRID_HEIGHT), _timeAccumulator(0.0f), _moveInterval(0.15f),
+      _worldWidth(0), _worldHeight(0) {
+    _hugeWorld = World::sizeFromEnvironment(_worldWidth, _worldHeight);
 }
 
 void Nibbler::init() {
-    _nibbler.clear();
-    _nibbler.push_back({Position(_gridWidth / 2, _gridHeight / 2)});
     _direction = Position(1, 0);
     _score = 0;
     _level = 1;
-    loadMapForLevel(_level);
+    _moveInterval = 0.15f;
+    _growth = 0;
+    _random.seed(Random::sessionSeed());
+    if (_hugeWorld) {
+        Position start(_worldWidth / 2, _worldHeight / 2);
+        _world = std::make_unique<World>(_worldWidth, _worldHeight, _random(), WORLD_OBSTACLES, start);
+        _nibbler.reset(World::BODY_CAPACITY, start);
+        _world->bodies().set(start.x, start.y);
+    } else {
+        loadMapForLevel(_level);
+        _nibbler.reset(static_cast<size_t>(_grid.getWidth()) * _grid.getHeight() + 1,
+                       Position(_gridWidth / 2, _gridHeight / 2));
+        const Position &head = _nibbler.head();
+        _grid.bodies().set(head.x, head.y);
+        _free.rebuild(_grid, head.x, head.y);
+    }
     spawnFood();
     _state = GameState::PLAYING;
     _timeAccumulator = 0.0f;
+    if (!_world) {
+        prepareLevel(_level + 1);
+    }
+}
+
+// A border with level * 2 random blocks, drawn from a generator seeded
+// with the game seed and the level number, so a seed always gives the same
+// levels. Layouts that cut off part of the board are redrawn. The snake
+// spawns on the cell with the longest clear run ahead, facing along it.
+std::unique_ptr<Nibbler::Level> Nibbler::generateLevel(int level, uint64_t seed) {
+    static constexpr auto border = borderMap<DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT>();
+    static const Position directions[4] = {Position(1, 0), Position(0, 1), Position(-1, 0), Position(0, -1)};
+    Random random(seed ^ (static_cast<uint64_t>(level) << 32));
+    auto result = std::make_unique<Level>();
+    Grid grid;
+    grid.resize(border.WIDTH, border.HEIGHT);
+
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        border.stampWalls(grid.walls());
+        // The last attempt keeps the bare border, which is always connected.
+        for (int i = 0; attempt < 63 && i < level * 2; ++i) {
+            int x = 2 + random.below(border.WIDTH - 4);
+            int y = 2 + random.below(border.HEIGHT - 4);
+            grid.walls().set(x, y);
+        }
+
+        int bestRun = -1;
+        for (int y = 0; y < border.HEIGHT; ++y) {
+            for (int x = 0; x < border.WIDTH; ++x) {
+                for (const Position &direction : directions) {
+                    int run = 0;
+                    while (!grid.isWall(x + direction.x * run, y + direction.y * run)) {
+                        run++;
+                    }
+                    if (run > bestRun) {
+                        bestRun = run;
+                        result->spawn = Position(x, y);
+                        result->direction = direction;
+                    }
+                }
+            }
+        }
+
+        result->free.rebuild(grid, result->spawn.x, result->spawn.y);
+        if (result->free.size() == grid.countFree()) {
+            break;
+        }
+    }
+
+    CompiledMap map;
+    map.width = border.WIDTH;
+    map.height = border.HEIGHT;
+    map.rowLengths.assign(border.HEIGHT, border.WIDTH);
+    map.walls = grid.walls();
+    grid.walls().forEach([&map](int x, int y) {
+        map.wallCells.push_back(Position(x, y));
+    });
+    // Open cells are drawn as floor, like the '.' cells of a text level.
+    map.dots.resize(border.WIDTH, border.HEIGHT);
+    for (int y = 1; y < border.HEIGHT - 1; ++y) {
+        for (int x = 1; x < border.WIDTH - 1; ++x) {
+            map.dots.assign(x, y, !grid.isWall(x, y));
+        }
+    }
+    result->map = std::make_shared<const CompiledMap>(std::move(map));
+    return result;
+}
+
+void Nibbler::prepareLevel(int level) {
+    _nextLevel = std::async(std::launch::async, &Nibbler::generateLevel, level, _random.getSeed());
+}
+
+// Swaps in a prepared level: its map, walls and free-cell index replace the
+// current ones, and the snake restarts from the spawn point, unrolling to
+// its full length over its next moves.
+void Nibbler::startLevel(std::unique_ptr<Level> level) {
+    size_t length = _nibbler.size();
+    _currentMap = std::move(level->map);
+    if (_grid.getWidth() != _currentMap->width || _grid.getHeight() != _currentMap->height) {
+        _grid.resize(_currentMap->width, _currentMap->height);
+    }
+    _currentMap->stampWalls(_grid.walls());
+    _grid.bodies().clear();
+    _grid.items().clear();
+    std::swap(_free, level->free);
+
+    _nibbler.reset(static_cast<size_t>(_grid.getWidth()) * _grid.getHeight() + 1, level->spawn);
+    _growth += static_cast<int>(length) - 1;
+    _direction = level->direction;
+    _grid.bodies().set(level->spawn.x, level->spawn.y);
+    _free.erase(level->spawn.x, level->spawn.y);
+}
+
+// Like Snake::snapshot: the play state with the level, the body and the
+// generator, then the world's seed or the free-cell order. The level map
+// follows from the level and the generator's seed, so restore() rebuilds
+// it only when either differs from this instance's.
+void Nibbler::snapshot(std::vector<uint8_t> &buffer) const {
+    SnapshotWriter out(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    bool food = _world ? _world->hasItem(_food.x, _food.y) : _grid.hasItem(_food.x, _food.y);
+    out.put(_hugeWorld);
+    out.put(_state);
+    out.put(_score);
+    out.put(_level);
+    out.put(_growth);
+    out.put(_food);
+    out.put(food);
+    out.put(_direction);
+    out.put(_timeAccumulator);
+    out.put(_moveInterval);
+    out.put(_random);
+    _nibbler.save(out);
+    if (_world) {
+        out.put(_world->getWidth());
+        out.put(_world->getHeight());
+        out.put(_world->getSeed());
+        out.put(_world->getStart());
+    } else {
+        out.putArray(_free.cells());
+    }
 }
 
-void Nibbler::loadLevel(int level) {
-    _walls.clear();
-    for (int x = 0; x < _gridWidth; ++x) {
-        _walls.push_back({x, 0});
-        _walls.push_back({x, _gridHeight - 1});
+bool Nibbler::restore(const std::vector<uint8_t> &buffer) {
+    SnapshotReader in(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    bool hugeWorld = false;
+    GameState state = GameState::MENU;
+    int score = 0;
+    int level = 1;
+    int growth = 0;
+    Position food;
+    bool hasFood = false;
+    Position direction;
+    float timeAccumulator = 0.0f;
+    float moveInterval = 0.0f;
+    Random random;
+    std::vector<Position> segments;
+    int worldWidth = 0;
+    int worldHeight = 0;
+    uint32_t worldSeed = 0;
+    Position worldStart;
+    std::vector<int> freeCells;
+
+    in.get(hugeWorld);
+    if (hugeWorld != _hugeWorld) {
+        return false;
     }
-    for (int y = 0; y < _gridHeight; ++y) {
-        _walls.push_back({0, y});
-        _walls.push_back({_gridWidth - 1, y});
+    in.get(state);
+    in.get(score);
+    in.get(level);
+    in.get(growth);
+    in.get(food);
+    in.get(hasFood);
+    in.get(direction);
+    in.get(timeAccumulator);
+    in.get(moveInterval);
+    in.get(random);
+    in.getArray(segments);
+    if (hugeWorld) {
+        in.get(worldWidth);
+        in.get(worldHeight);
+        in.get(worldSeed);
+        in.get(worldStart);
+    } else {
+        in.getArray(freeCells);
     }
-    for (int i = 0; i < level * 2; ++i) {
-        int x = 2 + rand() % (_gridWidth - 4);
-        int y = 2 + rand() % (_gridHeight - 4);
-        _walls.push_back({x, y});
+    if (!in.complete() || segments.empty() || level < 1) {
+        return false;
     }
+
+    bool sameLevel = _level == level && _random.getSeed() == random.getSeed();
+    _random = random;
+    if (hugeWorld) {
+        if (!_world || _world->getWidth() != worldWidth || _world->getHeight() != worldHeight
+            || _world->getSeed() != worldSeed || _world->getStart().x != worldStart.x
+            || _world->getStart().y != worldStart.y) {
+            _world = std::make_unique<World>(worldWidth, worldHeight, worldSeed, WORLD_OBSTACLES, worldStart);
+        }
+        _world->bodies().clear();
+        _world->items().clear();
+        _nibbler.assign(World::BODY_CAPACITY, segments.data(), segments.size());
+        for (const Position &segment : segments) {
+            _world->bodies().set(segment.x, segment.y);
+        }
+        if (hasFood) {
+            _world->items().set(food.x, food.y);
+        }
+        _world->follow(segments.front());
+    } else {
+        if (!_currentMap || !sameLevel) {
+            // Level 1 may come from a file; later ones are always generated.
+            if (level == 1) {
+                loadMapForLevel(level);
+            } else {
+                _currentMap = generateLevel(level, random.getSeed())->map;
+                _grid.resize(_currentMap->width, _currentMap->height);
+                _currentMap->stampWalls(_grid.walls());
+            }
+            prepareLevel(level + 1);
+        }
+        _grid.bodies().clear();
+        _grid.items().clear();
+        _nibbler.assign(static_cast<size_t>(_grid.getWidth()) * _grid.getHeight() + 1,
+                        segments.data(), segments.size());
+        for (const Position &segment : segments) {
+            _grid.bodies().set(segment.x, segment.y);
+        }
+        if (hasFood) {
+            _grid.items().set(food.x, food.y);
+        }
+        int start = freeCells.empty() ? -1 : freeCells.front();
+        _free.rebuild(_grid, start >= 0 ? start % _grid.getWidth() : segments.front().x,
+                      start >= 0 ? start / _grid.getWidth() : segments.front().y);
+        _free.assignCells(freeCells);
+    }
+    _state = state;
+    _score = score;
+    _level = level;
+    _growth = growth;
+    _food = food;
+    _direction = direction;
+    _timeAccumulator = timeAccumulator;
+    _moveInterval = moveInterval;
+    return true;
 }
 
 void Nibbler::loadMapForLevel(int level) {
     try {
         std::string mapFile = "assets/maps/nibbler/level" + std::to_string(level) + ".txt";
-        _currentMap = MapLoader::loadMap(mapFile);
-        
-        _walls.clear();
-        for (size_t y = 0; y < _currentMap.size(); ++y) {
-            for (size_t x = 0; x < _currentMap[y].size(); ++x) {
-                if (_currentMap[y][x] == '#') {
-                    _walls.push_back({static_cast<int>(x), static_cast<int>(y)});
-                }
-            }
-        }
+        _currentMap = MapLoader::load(mapFile);
     } catch (const std::exception& e) {
-        loadLevel(level);
+        _currentMap.reset();
     }
+
+    if (!_currentMap) {
+        _currentMap = generateLevel(level, _random.getSeed())->map;
+    }
+    _grid.resize(std::max(_gridWidth, _currentMap->width), std::max(_gridHeight, _currentMap->height));
+    _currentMap->stampWalls(_grid.walls());
 }
 
 void Nibbler::update(float deltaTime) {
@@ -65,20 +284,30 @@ void Nibbler::update(float deltaTime) {
     _timeAccumulator += deltaTime;
     if (_timeAccumulator >= _moveInterval) {
         _timeAccumulator -= _moveInterval;
-        moveNibbler();
-
-        if (checkCollision()) {
+        if (!moveNibbler()) {
             _state = GameState::GAME_OVER;
             return;
         }
 
-        if (_nibbler.front().position.x == _food.x && _nibbler.front().position.y == _food.y) {
+        const Position &head = _nibbler.head();
+        if (_world) {
+            _world->follow(head);
+        }
+        if (_world ? _world->hasItem(head.x, head.y) : _grid.hasItem(head.x, head.y)) {
+            if (_world) {
+                _world->items().reset(head.x, head.y);
+            } else {
+                _grid.items().reset(head.x, head.y);
+            }
             _score += 10 * _level;
-            _nibbler.push_back({_nibbler.back().position});
+            _growth++;
             
             if (_score >= _level * 100) {
                 _level++;
-                loadLevel(_level);
+                if (!_world) {
+                    startLevel(_nextLevel.get());
+                    prepareLevel(_level + 1);
+                }
                 _moveInterval = std::max(0.05f, 0.15f - (_level * 0.01f));
             }
             spawnFood();
@@ -87,25 +316,25 @@ void Nibbler::update(float deltaTime) {
 }
 
 void Nibbler::render(IGraphical &graphical) {
+    if (_world) {
+        renderWorld(graphical);
+        return;
+    }
     graphical.clear();
     graphical.setCellSize(_cellSize);
 
-    for (size_t y = 0; y < _currentMap.size(); ++y) {
-        for (size_t x = 0; x < _currentMap[y].size(); ++x) {
-            switch (_currentMap[y][x]) {
-                case '#':
-                    graphical.drawCell(x, y, Color(128, 128, 128));
-                    break;
-                case '.':
-                    graphical.drawCell(x, y, Color(50, 50, 50));
-                    break;
-            }
-        }
+    if (_currentMap) {
+        _currentMap->dots.forEach([&graphical](int x, int y) {
+            graphical.drawCell(x, y, Color(50, 50, 50));
+        });
     }
+    _grid.walls().forEach([&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(128, 128, 128));
+    });
 
-    for (const auto &segment : _nibbler) {
-        graphical.drawCell(segment.position.x, segment.position.y, Color(0, 255, 0));
-    }
+    _nibbler.forEach([&graphical](const Position &segment) {
+        graphical.drawCell(segment.x, segment.y, Color(0, 255, 0));
+    });
 
     graphical.drawCell(_food.x, _food.y, Color(255, 0, 0));
 
@@ -115,8 +344,42 @@ void Nibbler::render(IGraphical &graphical) {
     graphical.display();
 }
 
+// Draws the view around the head like Snake::renderWorld, with every open
+// cell of the view as floor.
+void Nibbler::renderWorld(IGraphical &graphical) {
+    auto start = std::chrono::steady_clock::now();
+    graphical.clear();
+    graphical.setCellSize(_cellSize);
+
+    for (int y = 0; y < _world->viewHeight(); y++) {
+        for (int x = 0; x < _world->viewWidth(); x++) {
+            if (!_world->isWall(_world->viewLeft() + x, _world->viewTop() + y)) {
+                graphical.drawCell(x, y, Color(50, 50, 50));
+            }
+        }
+    }
+    _world->forEachVisible(_world->walls(), [&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(128, 128, 128));
+    });
+    _world->forEachVisible(_world->bodies(), [&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(0, 255, 0));
+    });
+
+    int foodX = std::clamp(_food.x - _world->viewLeft(), 0, _world->viewWidth() - 1);
+    int foodY = std::clamp(_food.y - _world->viewTop(), 0, _world->viewHeight() - 1);
+    graphical.drawCell(foodX, foodY, _world->inView(_food.x, _food.y) ? Color(255, 0, 0) : Color(128, 0, 0));
+
+    graphical.drawText(Text("Score: " + std::to_string(_score), Position(10, 10), Color(255, 255, 255), 16));
+    graphical.drawText(Text("Level: " + std::to_string(_level), Position(10, 30), Color(255, 255, 255), 16));
+    _world->addFrame(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    graphical.display();
+}
+
 void Nibbler::stop() {
     _state = GameState::MENU;
+    if (_world) {
+        _world->report(std::cerr, "Nibbler");
+    }
 }
 
 void Nibbler::restart() {
@@ -147,93 +410,58 @@ void Nibbler::handleEvent(EventType event) {
     }
 }
 
-void Nibbler::moveNibbler() {
-    Position newHead = _nibbler.front().position;
+// Same rules as Snake: the tail cell is freed before the head is tested,
+// unless growth is pending, in which case the tail stays where it is.
+bool Nibbler::moveNibbler() {
+    Position newHead = _nibbler.head();
     newHead.x += _direction.x;
     newHead.y += _direction.y;
 
-    _nibbler.push_front({newHead});
-    _nibbler.pop_back();
-}
-
-bool Nibbler::checkCollision() {
-    const Position &head = _nibbler.front().position;
-
-    for (const auto &wall : _walls) {
-        if (head.x == wall.x && head.y == wall.y) {
-            return true;
-        }
-    }
-
-    for (size_t i = 1; i < _nibbler.size(); ++i) {
-        if (head.x == _nibbler[i].position.x && head.y == _nibbler[i].position.y) {
-            return true;
+    if (_growth > 0) {
+        _growth--;
+    } else {
+        Position tail = _nibbler.tail();
+        _nibbler.popTail();
+        if (_world) {
+            _world->bodies().reset(tail.x, tail.y);
+        } else {
+            _grid.bodies().reset(tail.x, tail.y);
+            _free.insert(tail.x, tail.y);
         }
     }
 
-    return false;
-}
-
-bool Nibbler::isCollision(const Position& pos) const {
-    for (const auto& wall : _walls) {
-        if (pos.x == wall.x && pos.y == wall.y) {
-            return true;
-        }
+    if (_world) {
+        bool collided = _world->isBlocked(newHead.x, newHead.y);
+        _nibbler.pushHead(newHead);
+        _world->bodies().set(newHead.x, newHead.y);
+        return !collided;
     }
-    return false;
+    bool collided = _grid.isBlocked(newHead.x, newHead.y);
+    _nibbler.pushHead(newHead);
+    _grid.bodies().set(newHead.x, newHead.y);
+    _free.erase(newHead.x, newHead.y);
+    return !collided;
 }
 
+// Picks uniformly among free cells reachable from the head, so food never
+// lands inside an area closed off by the random walls of later levels. In
+// a huge world it goes to a free cell of the view, as for Snake.
 void Nibbler::spawnFood() {
-    bool validPosition;
-    int maxAttempts = 100;
-    int attempts = 0;
-
-    do {
-        attempts++;
-        int minX = 2;
-        int maxX = _gridWidth - 3;
-        int minY = 2;
-        int maxY = _gridHeight - 3;
-
-        _food.x = minX + rand() % (maxX - minX + 1);
-        _food.y = minY + rand() % (maxY - minY + 1);
-        
-        validPosition = true;
-        
-        if (isCollision(_food)) {
-            validPosition = false;
-            continue;
-        }
-        
-        for (const auto &segment : _nibbler) {
-            if (segment.position.x == _food.x && segment.position.y == _food.y) {
-                validPosition = false;
-                break;
-            }
-        }
-
-        if (attempts >= maxAttempts) {
-            for (int x = 2; x < _gridWidth - 2; x++) {
-                for (int y = 2; y < _gridHeight - 2; y++) {
-                    Position testPos = {x, y};
-                    if (!isCollision(testPos)) {
-                        bool snakeCollision = false;
-                        for (const auto &segment : _nibbler) {
-                            if (segment.position.x == x && segment.position.y == y) {
-                                snakeCollision = true;
-                                break;
-                            }
-                        }
-                        if (!snakeCollision) {
-                            _food = testPos;
-                            return;
-                        }
-                    }
-                }
-            }
-            break;
+    if (_world) {
+        if (!_world->sampleFree(_random, _food.x, _food.y)) {
+            _state = GameState::WIN;
+            return;
         }
-    } while (!validPosition);
+        _world->items().set(_food.x, _food.y);
+        return;
+    }
+    if (_free.empty()) {
+        _state = GameState::WIN;
+        return;
+    }
+    _free.sample(_random(), _food.x, _food.y);
+    _free.erase(_food.x, _food.y);
+    _grid.items().set(_food.x, _food.y);
 }
 
 GameState Nibbler::getState() const {
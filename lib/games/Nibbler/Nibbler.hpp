@@ -2,7 +2,15 @@
 #define NIBBLER_HPP_
 
 #include "../../../src/interfaces/IGame.hpp"
-#include <deque>
+#include "../../../src/interfaces/BuiltinMaps.hpp"
+#include "../../../src/interfaces/Grid.hpp"
+#include "../../../src/interfaces/MapFile.hpp"
+#include "../../../src/interfaces/Random.hpp"
+#include "../../../src/interfaces/SnakeBody.hpp"
+#include "../../../src/interfaces/World.hpp"
+#include <cstdint>
+#include <future>
+#include <memory>
 #include <vector>
 
 namespace arcade {
@@ -24,16 +32,35 @@ public:
     void setState(GameState state) override;
     std::string getName() const override;
     std::string getDescription() const override;
+    void snapshot(std::vector<uint8_t> &buffer) const override;
+    bool restore(const std::vector<uint8_t> &buffer) override;
 
 private:
-    struct Segment {
-        Position position;
+    // Board of the generated levels.
+    static constexpr int DEFAULT_GRID_WIDTH = 30;
+    static constexpr int DEFAULT_GRID_HEIGHT = 20;
+    // Share of a huge world's cells that are obstacles, in 1024ths.
+    static constexpr int WORLD_OBSTACLES = 8;
+    // Snapshot layout; bump the version whenever snapshot() changes.
+    static constexpr char SNAPSHOT_TAG[] = "NIBL";
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    // A level built off the game thread, ready to be swapped in: its map,
+    // the free cells reachable from the spawn point, and where the snake
+    // starts and heads.
+    struct Level {
+        std::shared_ptr<const CompiledMap> map;
+        FreeCells free;
+        Position spawn;
+        Position direction;
     };
 
-    std::deque<Segment> _nibbler;
+    SnakeBody _nibbler;
+    int _growth;
     Position _food;
     Position _direction;
-    std::vector<Position> _walls;
+    Grid _grid;
+    FreeCells _free;
     GameState _state;
     int _score;
     int _level;
@@ -42,14 +69,26 @@ private:
     int _gridHeight;
     float _timeAccumulator;
     float _moveInterval;
-    std::vector<std::string> _currentMap;
+    std::shared_ptr<const CompiledMap> _currentMap;
+    // Food placement; its seed also draws the levels. Reseeded by every
+    // init().
+    Random _random;
+    std::future<std::unique_ptr<Level>> _nextLevel;
+    // Huge-world mode (ARCADE_WORLD_SIZE): one scattered-obstacle World for
+    // every level, so levels only speed the game up; _grid and _free stay
+    // empty.
+    bool _hugeWorld;
+    int _worldWidth;
+    int _worldHeight;
+    std::unique_ptr<World> _world;
     void loadMapForLevel(int level);
 
-    void loadLevel(int level);
+    static std::unique_ptr<Level> generateLevel(int level, uint64_t seed);
+    void prepareLevel(int level);
+    void startLevel(std::unique_ptr<Level> level);
     void spawnFood();
-    void moveNibbler();
-    bool checkCollision();
-    bool isCollision(const Position& pos) const;
+    bool moveNibbler();
+    void renderWorld(IGraphical &graphical);
 };
 
 }
@@ -0,0 +1,86 @@
+#ifndef ENTITIES_HPP
+#define ENTITIES_HPP
+
+#include "../../../src/interfaces/Snapshot.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace arcade {
+
+// Pacman's actors as a structure of arrays: one packed column per field,
+// indexed by entity. Positions are cell indices (y * width + x, as in Maze
+// and FlowField), so moving every ghost along the flow field is one gather
+// over a column and a collision test is one compare over it. The player is
+// entity PLAYER and the ghosts follow it.
+class Entities {
+public:
+    enum Type : uint8_t {
+        PACMAN,
+        GHOST
+    };
+
+    static constexpr size_t PLAYER = 0;
+    static constexpr size_t FIRST_GHOST = 1;
+
+    size_t size() const { return _cells.size(); }
+    size_t ghostCount() const { return size() > FIRST_GHOST ? size() - FIRST_GHOST : 0; }
+
+    void clear() {
+        _cells.clear();
+        _directions.clear();
+        _speeds.clear();
+        _types.clear();
+        _colors.clear();
+    }
+    void reserve(size_t count) {
+        _cells.reserve(count);
+        _directions.reserve(count);
+        _speeds.reserve(count);
+        _types.reserve(count);
+        _colors.reserve(count);
+    }
+
+    // Appends an entity; color indexes the game's palette.
+    size_t add(Type type, int cell, int direction, int speed, int color) {
+        _cells.push_back(cell);
+        _directions.push_back(static_cast<uint8_t>(direction));
+        _speeds.push_back(static_cast<uint8_t>(speed));
+        _types.push_back(type);
+        _colors.push_back(static_cast<uint8_t>(color));
+        return _cells.size() - 1;
+    }
+
+    // Every column as one snapshot array, and back; load() leaves the
+    // store unusable when it fails, so read into a spare one.
+    void save(SnapshotWriter &out) const {
+        out.putArray(_cells);
+        out.putArray(_directions);
+        out.putArray(_speeds);
+        out.putArray(_types);
+        out.putArray(_colors);
+    }
+    bool load(SnapshotReader &in) {
+        return in.getArray(_cells) && in.getArray(_directions) && in.getArray(_speeds) && in.getArray(_types)
+            && in.getArray(_colors) && _directions.size() == _cells.size() && _speeds.size() == _cells.size()
+            && _types.size() == _cells.size() && _colors.size() == _cells.size();
+    }
+
+    int *cells() { return _cells.data(); }
+    const int *cells() const { return _cells.data(); }
+    uint8_t *directions() { return _directions.data(); }
+    const uint8_t *directions() const { return _directions.data(); }
+    const uint8_t *speeds() const { return _speeds.data(); }
+    const uint8_t *types() const { return _types.data(); }
+    const uint8_t *colors() const { return _colors.data(); }
+
+private:
+    std::vector<int> _cells;
+    std::vector<uint8_t> _directions;
+    std::vector<uint8_t> _speeds;
+    std::vector<uint8_t> _types;
+    std::vector<uint8_t> _colors;
+};
+
+}
+
+#endif
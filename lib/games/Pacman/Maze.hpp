@@ -0,0 +1,224 @@
+#ifndef MAZE_HPP
+#define MAZE_HPP
+
+#include "../../../src/interfaces/IGraphical.hpp"
+#include "../../../src/interfaces/Grid.hpp"
+#include "../../../src/interfaces/MapFile.hpp"
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// A Pacman map compiled once into what play needs: a tile array (walls
+// layer, starting dots in the items layer), the neighbours of every cell
+// with tunnels already resolved, and a graph of the junctions between
+// corridors.
+//
+// Map characters: '#' wall, '.' dot, ' ' empty floor, 'P' Pacman's start,
+// 'G' a ghost start. Short rows are padded with wall. A row whose first and
+// last characters are both open is a tunnel: leaving one end enters the
+// other, and likewise for a column open at the top and bottom rows.
+class Maze {
+public:
+    enum Direction {
+        UP,
+        RIGHT,
+        DOWN,
+        LEFT,
+        DIRECTION_COUNT
+    };
+
+    // A cell where moving on is a choice: an intersection or a dead end.
+    // For each exit, the junction the corridor leads to and its length.
+    struct Junction {
+        Position position;
+        int next[DIRECTION_COUNT];
+        int length[DIRECTION_COUNT];
+    };
+
+    static Direction opposite(int direction) {
+        return static_cast<Direction>((direction + 2) % DIRECTION_COUNT);
+    }
+
+    void compile(const CompiledMap &map) {
+        int width = map.width;
+        int height = map.height;
+        _grid.resize(width, height);
+        _grid.walls() = map.walls;
+        _grid.items() = map.dots;
+        for (int y = 0; y < height; y++) {
+            for (int x = map.rowLengths[y]; x < width; x++) {
+                _grid.walls().set(x, y);
+            }
+        }
+        _pacmanStart = Position(-1, -1);
+        _ghostStarts.clear();
+        for (const auto &marker : map.markers) {
+            if (marker.tile == 'P') {
+                _pacmanStart = marker.position;
+            } else if (marker.tile == 'G') {
+                _ghostStarts.push_back(marker.position);
+            }
+        }
+
+        _rowEnds.assign(height, -1);
+        for (int y = 0; y < height; y++) {
+            int end = map.rowLengths[y] - 1;
+            if (end > 0 && !_grid.isWall(0, y) && !_grid.isWall(end, y)) {
+                _rowEnds[y] = end;
+            }
+        }
+        _columnWraps.assign(width, false);
+        for (int x = 0; x < width && height > 1; x++) {
+            _columnWraps[x] = !_grid.isWall(x, 0) && !_grid.isWall(x, height - 1);
+        }
+
+        _exits.assign(static_cast<size_t>(width) * height, 0);
+        _links.assign(_exits.size() * DIRECTION_COUNT, Position(-1, -1));
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (_grid.isWall(x, y)) {
+                    continue;
+                }
+                for (int d = 0; d < DIRECTION_COUNT; d++) {
+                    int nx = x;
+                    int ny = y;
+                    if (neighbour(nx, ny, d)) {
+                        _exits[index(x, y)] |= 1 << d;
+                        _links[index(x, y) * DIRECTION_COUNT + d] = Position(nx, ny);
+                    }
+                }
+            }
+        }
+        buildJunctions();
+    }
+
+    int getWidth() const { return _grid.getWidth(); }
+    int getHeight() const { return _grid.getHeight(); }
+    bool isWall(int x, int y) const { return _grid.isWall(x, y); }
+    const GridLayer &walls() const { return _grid.walls(); }
+    // Dots of a fresh game.
+    const GridLayer &dots() const { return _grid.items(); }
+    const Position &getPacmanStart() const { return _pacmanStart; }
+    const std::vector<Position> &getGhostStarts() const { return _ghostStarts; }
+
+    // Bit d set when direction d leads to an open cell.
+    uint8_t exits(int x, int y) const {
+        return _grid.isWall(x, y) ? 0 : _exits[index(x, y)];
+    }
+
+    // Moves (x, y) one cell towards direction through tunnels; false and
+    // unchanged when a wall is in the way.
+    bool step(int &x, int &y, int direction) const {
+        if (!(exits(x, y) & (1 << direction))) {
+            return false;
+        }
+        const Position &next = _links[index(x, y) * DIRECTION_COUNT + direction];
+        x = next.x;
+        y = next.y;
+        return true;
+    }
+
+    // Board interface of FlowField.
+    template <typename Fn>
+    void forEachNeighbour(int x, int y, Fn &&fn) const {
+        if (_grid.isWall(x, y)) {
+            return;
+        }
+        const Position *links = &_links[index(x, y) * DIRECTION_COUNT];
+        for (int d = 0; d < DIRECTION_COUNT; d++) {
+            if (links[d].x >= 0) {
+                fn(links[d].x, links[d].y);
+            }
+        }
+    }
+
+    const std::vector<Junction> &getJunctions() const { return _junctions; }
+    // Junction index at a cell, or -1 inside a corridor.
+    int junctionAt(int x, int y) const {
+        return _grid.isWall(x, y) ? -1 : _junctionIndex[index(x, y)];
+    }
+
+private:
+    Grid _grid;
+    Position _pacmanStart;
+    std::vector<Position> _ghostStarts;
+    std::vector<int> _rowEnds;
+    std::vector<bool> _columnWraps;
+    std::vector<uint8_t> _exits;
+    // Cell reached from each cell in each direction, x -1 when walled.
+    std::vector<Position> _links;
+    std::vector<Junction> _junctions;
+    std::vector<int> _junctionIndex;
+
+    size_t index(int x, int y) const {
+        return static_cast<size_t>(y) * _grid.getWidth() + x;
+    }
+
+    // Cell next to (x, y) in direction, wrapping through tunnels.
+    bool neighbour(int &x, int &y, int direction) const {
+        static const int dx[DIRECTION_COUNT] = {0, 1, 0, -1};
+        static const int dy[DIRECTION_COUNT] = {-1, 0, 1, 0};
+        int nx = x + dx[direction];
+        int ny = y + dy[direction];
+        if (ny == y && _rowEnds[y] >= 0) {
+            if (nx < 0) {
+                nx = _rowEnds[y];
+            } else if (nx > _rowEnds[y]) {
+                nx = 0;
+            }
+        }
+        if (nx == x && _columnWraps[x]) {
+            if (ny < 0) {
+                ny = getHeight() - 1;
+            } else if (ny >= getHeight()) {
+                ny = 0;
+            }
+        }
+        if (_grid.isWall(nx, ny)) {
+            return false;
+        }
+        x = nx;
+        y = ny;
+        return true;
+    }
+
+    // Every open cell with other than two exits is a junction; straight and
+    // bent corridor cells between them are walked once to link the graph.
+    void buildJunctions() {
+        _junctions.clear();
+        _junctionIndex.assign(_exits.size(), -1);
+        for (int y = 0; y < getHeight(); y++) {
+            for (int x = 0; x < getWidth(); x++) {
+                if (!_grid.isWall(x, y) && __builtin_popcount(_exits[index(x, y)]) != 2) {
+                    _junctionIndex[index(x, y)] = static_cast<int>(_junctions.size());
+                    _junctions.push_back({Position(x, y), {-1, -1, -1, -1}, {0, 0, 0, 0}});
+                }
+            }
+        }
+        for (auto &junction : _junctions) {
+            for (int d = 0; d < DIRECTION_COUNT; d++) {
+                int x = junction.position.x;
+                int y = junction.position.y;
+                int heading = d;
+                int length = 0;
+                while (step(x, y, heading)) {
+                    length++;
+                    int found = _junctionIndex[index(x, y)];
+                    if (found >= 0) {
+                        junction.next[d] = found;
+                        junction.length[d] = length;
+                        break;
+                    }
+                    // A corridor cell: carry on through its other exit.
+                    uint8_t onward = _exits[index(x, y)] & ~(1 << opposite(heading));
+                    heading = __builtin_ctz(onward);
+                }
+            }
+        }
+    }
+};
+
+}
+
+#endif
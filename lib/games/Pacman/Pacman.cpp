@@ -1,42 +1,177 @@
 #include "Pacman.hpp"
+#include "../../../src/interfaces/MapLoader.hpp"
+#include "../../../src/interfaces/Snapshot.hpp"
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
-#include <ctime>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PACMAN_HAS_X86 1
+#endif
 
 namespace arcade {
 
+namespace {
+
+// Ghost colours in spawn order, then Pacman's.
+const Color PALETTE[] = {
+    Color(255, 0, 0), Color(255, 192, 203), Color(0, 255, 255), Color(255, 165, 0), Color(255, 255, 0)
+};
+constexpr int GHOST_COLORS = 4;
+constexpr int PACMAN_COLOR = 4;
+
+// Moves every cell of the column to its entry in next.
+void stepScalar(int *cells, size_t count, const int *next) {
+    for (size_t i = 0; i < count; ++i) {
+        cells[i] = next[cells[i]];
+    }
+}
+
+// Index of the first entry of the column equal to cell, or count.
+size_t findScalar(const int *cells, size_t count, int cell) {
+    for (size_t i = 0; i < count; ++i) {
+        if (cells[i] == cell) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef PACMAN_HAS_X86
+
+__attribute__((target("sse2")))
+size_t findSSE2(const int *cells, size_t count, int cell) {
+    const __m128i wanted = _mm_set1_epi32(cell);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i four = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(four, wanted)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < count; ++i) {
+        if (cells[i] == cell) {
+            return i;
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+void stepAVX2(int *cells, size_t count, const int *next) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i eight = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(cells + i), _mm256_i32gather_epi32(next, eight, 4));
+    }
+    for (; i < count; ++i) {
+        cells[i] = next[cells[i]];
+    }
+}
+
+__attribute__((target("avx2")))
+size_t findAVX2(const int *cells, size_t count, int cell) {
+    const __m256i wanted = _mm256_set1_epi32(cell);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i eight = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cells + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(eight, wanted)));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < count; ++i) {
+        if (cells[i] == cell) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#endif
+
+}
+
+// ARCADE_PACMAN_GHOSTS=<count> turns the game into a ghost benchmark.
+static size_t benchmarkGhosts() {
+    const char *count = std::getenv("ARCADE_PACMAN_GHOSTS");
+    return count ? std::strtoul(count, nullptr, 10) : 0;
+}
+
 Pacman::Pacman() : 
-    _pacman{Position(10, 10), Color(255, 255, 0), 1},
+    _stepCells(stepScalar),
+    _findCell(findScalar),
+    _kernelName("scalar"),
+    _dotCount(0),
+    _benchmarkGhosts(benchmarkGhosts()),
+    _ghostSteps(0),
+    _ghostTicks(0),
+    _ghostSeconds(0),
+    _fieldBuilds(0),
+    _fieldSeconds(0),
     _state(GameState::MENU),
     _score(0),
     _cellSize(20),
     _moveTimer(0),
-    _moveInterval(0.5f) {
-    srand(time(nullptr));
+    _moveInterval(_benchmarkGhosts > 0 ? 0.0f : 0.5f) {
+    selectKernels();
+}
+
+// ARCADE_PACMAN_SIMD=scalar or sse2 caps the kernels, as ARCADE_SOFT_SIMD
+// does for the Soft renderer.
+void Pacman::selectKernels() {
+    const char *forced = std::getenv("ARCADE_PACMAN_SIMD");
+    std::string wanted = forced ? forced : "";
+
+    _stepCells = stepScalar;
+    _findCell = findScalar;
+    _kernelName = "scalar";
+#ifdef PACMAN_HAS_X86
+    __builtin_cpu_init();
+    if (wanted != "scalar" && __builtin_cpu_supports("sse2")) {
+        _findCell = findSSE2;
+        _kernelName = "sse2";
+    }
+    if (wanted != "scalar" && wanted != "sse2" && __builtin_cpu_supports("avx2")) {
+        _stepCells = stepAVX2;
+        _findCell = findAVX2;
+        _kernelName = "avx2";
+    }
+#endif
+}
+
+Position Pacman::cellPosition(int cell) const {
+    return Position(cell % _gameWidth, cell / _gameWidth);
 }
 
 void Pacman::init() {
-    _gameWidth = 20;
-    _gameHeight = 20;
-    
-    _pacman.position = Position(_gameWidth / 2, _gameHeight / 2);
-    _pacman.color = Color(255, 255, 0);
-    _pacman.speed = 1;
+    if (_maze.getWidth() == 0) {
+        loadMaze();
+    }
+    _gameWidth = _maze.getWidth();
+    _gameHeight = _maze.getHeight();
     
-    _ghosts.clear();
-    _ghosts.push_back({{2, 2}, Color(255, 0, 0), 1});
-    _ghosts.push_back({{_gameWidth-3, 2}, Color(255, 192, 203), 1});
-    _ghosts.push_back({{2, _gameHeight-3}, Color(0, 255, 255), 1});
-    _ghosts.push_back({{_gameWidth-3, _gameHeight-3}, Color(255, 165, 0), 1});
+    Position start = _maze.getPacmanStart();
+    if (_maze.isWall(start.x, start.y)) {
+        start = nearestCell(Position(_gameWidth / 2, _gameHeight / 2), false);
+    }
+    _random.seed(Random::sessionSeed());
+    _entities.clear();
+    _entities.add(Entities::PACMAN, start.y * _gameWidth + start.x, Maze::LEFT, 1, PACMAN_COLOR);
     
     spawnDots();
-    spawnWalls();
+    _chase.compute(_maze, start.x, start.y);
+    spawnGhosts();
     _state = GameState::PLAYING;
     _score = 0;
 }
 
 void Pacman::stop() {
     _state = GameState::MENU;
+    reportBenchmark();
 }
 
 void Pacman::restart() {
@@ -50,13 +185,11 @@ void Pacman::update(float deltaTime) {
     if (_moveTimer >= _moveInterval) {
         _moveTimer = 0;
         
-        for (auto& ghost : _ghosts) {
-            moveGhost(ghost);
-        }
+        moveGhosts();
     }
     
     checkCollisions();
-    if (_dots.empty()) {
+    if (_dotCount == 0) {
         _state = GameState::WIN;
     }
 }
@@ -65,24 +198,27 @@ void Pacman::render(IGraphical &graphical) {
     graphical.clear();
     graphical.setCellSize(_cellSize);
     
-    for (const auto& wall : _walls) {
-        graphical.drawCell(wall.x, wall.y, Color(100, 100, 100));
-    }
-    for (const auto& dot : _dots) {
+    _maze.walls().forEach([&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(100, 100, 100));
+    });
+    _dots.forEach([this, &graphical](int x, int y) {
         Position dotPos;
-        dotPos.x = dot.x * _cellSize + _cellSize/2;
-        dotPos.y = dot.y * _cellSize + _cellSize/2;
-        
+        dotPos.x = x * _cellSize + _cellSize/2;
+        dotPos.y = y * _cellSize + _cellSize/2;
+
         Color dotColor(255, 215, 0);
-        
+
         graphical.drawCircle(dotPos, _cellSize/6, dotColor);
-    }
+    });
     
-    for (const auto& ghost : _ghosts) {
-        graphical.drawCell(ghost.position.x, ghost.position.y, ghost.color);
+    const int *cells = _entities.cells();
+    const uint8_t *colors = _entities.colors();
+    for (size_t i = Entities::FIRST_GHOST; i < _entities.size(); i++) {
+        graphical.drawCell(cells[i] % _gameWidth, cells[i] / _gameWidth, PALETTE[colors[i]]);
     }
     
-    graphical.drawCell(_pacman.position.x, _pacman.position.y, _pacman.color);
+    Position pacman = cellPosition(cells[Entities::PLAYER]);
+    graphical.drawCell(pacman.x, pacman.y, PALETTE[colors[Entities::PLAYER]]);
     
     Text scoreText("Score: " + std::to_string(_score), Position(0, 0), Color(255, 255, 255), 16);
     graphical.drawText(scoreText);
@@ -112,93 +248,256 @@ void Pacman::handleEvent(EventType event) {
 }
 
 void Pacman::updatePacmanPosition(EventType direction) {
-    Position newPos = _pacman.position;
-
+    uint8_t &heading = _entities.directions()[Entities::PLAYER];
     switch (direction) {
-        case EventType::MOVE_UP:    newPos.y--; break;
-        case EventType::MOVE_DOWN:  newPos.y++; break;
-        case EventType::MOVE_LEFT:  newPos.x--; break;
-        case EventType::MOVE_RIGHT: newPos.x++; break;
+        case EventType::MOVE_UP:    heading = Maze::UP; break;
+        case EventType::MOVE_DOWN:  heading = Maze::DOWN; break;
+        case EventType::MOVE_LEFT:  heading = Maze::LEFT; break;
+        case EventType::MOVE_RIGHT: heading = Maze::RIGHT; break;
         default: return;
     }
-
-    if (!isCollision(newPos) && 
-        newPos.x >= 1 && newPos.x < _gameWidth - 1 &&
-        newPos.y >= 1 && newPos.y < _gameHeight - 1) {
-        _pacman.position = newPos;
-    }
+    int &cell = _entities.cells()[Entities::PLAYER];
+    Position position = cellPosition(cell);
+    _maze.step(position.x, position.y, heading);
+    cell = position.y * _gameWidth + position.x;
 }
 
 void Pacman::checkCollisions() {
-    auto dotIt = std::remove_if(_dots.begin(), _dots.end(), 
-        [this](const Position& dot) {
-            return dot.x == _pacman.position.x && dot.y == _pacman.position.y;
-        });
-    if (dotIt != _dots.end()) {
-        _dots.erase(dotIt, _dots.end());
+    const int *cells = _entities.cells();
+    Position pacman = cellPosition(cells[Entities::PLAYER]);
+    if (_dots.test(pacman.x, pacman.y)) {
+        _dots.reset(pacman.x, pacman.y);
+        _dotCount--;
         _score += 10;
     }
-    for (const auto& ghost : _ghosts) {
-        if (ghost.position.x == _pacman.position.x && 
-            ghost.position.y == _pacman.position.y) {
-            _state = GameState::GAME_OVER;
-            break;
+    if (_benchmarkGhosts > 0) {
+        return;
+    }
+    size_t ghosts = _entities.ghostCount();
+    if (_findCell(cells + Entities::FIRST_GHOST, ghosts, cells[Entities::PLAYER]) < ghosts) {
+        _state = GameState::GAME_OVER;
+    }
+}
+
+// The play state, the entity columns and the remaining dots. The maze is
+// compiled once per instance and not copied, only its size to check
+// against; the chase field follows from Pacman's cell and is rebuilt on
+// restore when it points elsewhere.
+void Pacman::snapshot(std::vector<uint8_t> &buffer) const {
+    SnapshotWriter out(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    out.put(_gameWidth);
+    out.put(_gameHeight);
+    out.put(_state);
+    out.put(_score);
+    out.put(_moveTimer);
+    out.put(_random);
+    _entities.save(out);
+    out.put(_dotCount);
+    out.putArray(_dots.words());
+}
+
+bool Pacman::restore(const std::vector<uint8_t> &buffer) {
+    SnapshotReader in(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    int width = 0;
+    int height = 0;
+    GameState state = GameState::MENU;
+    int score = 0;
+    float moveTimer = 0;
+    Random random;
+    Entities entities;
+    size_t dotCount = 0;
+    std::vector<uint64_t> dots;
+
+    in.get(width);
+    in.get(height);
+    in.get(state);
+    in.get(score);
+    in.get(moveTimer);
+    in.get(random);
+    entities.load(in);
+    in.get(dotCount);
+    in.getArray(dots);
+    if (!in.complete() || entities.size() == 0) {
+        return false;
+    }
+    if (_maze.getWidth() == 0) {
+        loadMaze();
+    }
+    if (_maze.getWidth() != width || _maze.getHeight() != height) {
+        return false;
+    }
+    const int *cells = entities.cells();
+    for (size_t i = 0; i < entities.size(); i++) {
+        if (cells[i] < 0 || cells[i] >= width * height) {
+            return false;
         }
     }
+
+    _gameWidth = width;
+    _gameHeight = height;
+    _state = state;
+    _score = score;
+    _moveTimer = moveTimer;
+    _random = random;
+    _entities = std::move(entities);
+    _dots = _maze.dots();
+    _dots.assignWords(dots);
+    _dotCount = dotCount;
+    Position pacman = cellPosition(_entities.cells()[Entities::PLAYER]);
+    if (!_chase.hasTarget(pacman.x, pacman.y)) {
+        _chase.compute(_maze, pacman.x, pacman.y);
+    }
+    return true;
 }
 
 void Pacman::spawnDots() {
-    _dots.clear();
-    for (int x = 1; x < _gameWidth - 1; x++) {
-        for (int y = 1; y < _gameHeight - 1; y++) {
-            if (!isCollision({x, y})) {
-                _dots.push_back({x, y});
+    _dots = _maze.dots();
+    _dotCount = _dots.count();
+}
+
+// The level map, or the built-in maze when it cannot be read; the
+// benchmark uses a large open maze with pillars instead. Both fallbacks are
+// built at compile time.
+void Pacman::loadMaze() {
+    if (_benchmarkGhosts > 0) {
+        static constexpr auto benchmarkMaze = pillarMap<BENCHMARK_MAZE_SIZE, BENCHMARK_MAZE_SIZE, 5, 4>();
+        _maze.compile(benchmarkMaze.toCompiledMap());
+        return;
+    }
+    try {
+        _maze.compile(*MapLoader::load("assets/maps/pacman/level1.txt"));
+    } catch (const std::exception &e) {
+        _maze.compile(DEFAULT_PACMAN_MAP.toCompiledMap());
+    }
+}
+
+// Open cell nearest to from; when chasing, only one from which Pacman can
+// be reached, other than his own.
+Position Pacman::nearestCell(const Position &from, bool chasing) const {
+    Position best = from;
+    int bestDistance = -1;
+    for (int y = 0; y < _gameHeight; y++) {
+        for (int x = 0; x < _gameWidth; x++) {
+            int distance = std::abs(x - from.x) + std::abs(y - from.y);
+            bool usable = chasing ? _chase.distance(x, y) > 0 : !_maze.isWall(x, y);
+            if (usable && (bestDistance < 0 || distance < bestDistance)) {
+                best = Position(x, y);
+                bestDistance = distance;
             }
         }
     }
+    return best;
 }
 
-void Pacman::spawnWalls() {
-    _walls.clear();
-    
-    for (int x = 0; x < _gameWidth; x++) {
-        _walls.push_back({x, 0});
-        _walls.push_back({x, _gameHeight - 1});
-    }
-    for (int y = 0; y < _gameHeight; y++) {
-        _walls.push_back({0, y});
-        _walls.push_back({_gameWidth - 1, y});
+// Ghosts start on the map's 'G' cells, or near the four corners; the
+// benchmark scatters its ghosts over every open cell of the maze instead.
+void Pacman::spawnGhosts() {
+    if (_benchmarkGhosts == 0) {
+        std::vector<Position> starts = _maze.getGhostStarts();
+        if (starts.empty()) {
+            starts = {
+                nearestCell(Position(2, 2), true),
+                nearestCell(Position(_gameWidth - 3, 2), true),
+                nearestCell(Position(2, _gameHeight - 3), true),
+                nearestCell(Position(_gameWidth - 3, _gameHeight - 3), true)
+            };
+        }
+        for (size_t i = 0; i < starts.size(); i++) {
+            _entities.add(Entities::GHOST, starts[i].y * _gameWidth + starts[i].x, Maze::UP, 1, i % GHOST_COLORS);
+        }
+        return;
     }
-    for (int x = 5; x < 15; x += 4) {
-        for (int y = 5; y < 15; y += 4) {
-            _walls.push_back({x, y});
+
+    size_t cells = static_cast<size_t>(_gameWidth) * _gameHeight;
+    _entities.reserve(Entities::FIRST_GHOST + _benchmarkGhosts);
+    for (size_t i = 0; i < _benchmarkGhosts; i++) {
+        size_t cell = (i * 7919 + 1) % cells;
+        for (size_t tries = 0; tries < cells && _chase.distance(cell % _gameWidth, cell / _gameWidth) <= 0; tries++) {
+            cell = (cell + 1) % cells;
         }
+        _entities.add(Entities::GHOST, static_cast<int>(cell), Maze::UP, 1, i % GHOST_COLORS);
     }
 }
 
-void Pacman::moveGhost(Entity& ghost) {
-    Position oldPos = ghost.position;
-    int direction = rand() % 4;
-
-    switch (direction) {
-        case 0: ghost.position.y -= ghost.speed; break;
-        case 1: ghost.position.x += ghost.speed; break;
-        case 2: ghost.position.y += ghost.speed; break;
-        case 3: ghost.position.x -= ghost.speed; break;
+// The flow field is rebuilt only when Pacman has changed cell since the
+// last ghost step. Every ghost then follows it in one gather over the cell
+// column; ghosts it cannot lead to Pacman stay put in that pass and wander
+// in a second one.
+void Pacman::moveGhosts() {
+    auto start = std::chrono::steady_clock::now();
+    Position pacman = cellPosition(_entities.cells()[Entities::PLAYER]);
+    if (!_chase.hasTarget(pacman.x, pacman.y)) {
+        _chase.compute(_maze, pacman.x, pacman.y);
+        _fieldBuilds++;
+        _fieldSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
     }
+    int *ghosts = _entities.cells() + Entities::FIRST_GHOST;
+    size_t count = _entities.ghostCount();
+    _stepCells(ghosts, count, _chase.nextCells());
+    const int *distances = _chase.distances();
+    for (size_t i = 0; i < count; i++) {
+        if (distances[ghosts[i]] < 0) {
+            wander(Entities::FIRST_GHOST + i);
+        }
+    }
+    _ghostTicks++;
+    _ghostSteps += count;
+    _ghostSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A ghost walled off from Pacman follows corridors, and only at a
+// junction of the maze graph does it pick a new way, never straight back
+// unless cornered.
+void Pacman::wander(size_t ghost) {
+    int &cell = _entities.cells()[ghost];
+    uint8_t &direction = _entities.directions()[ghost];
+    Position position = cellPosition(cell);
 
-    if (isCollision(ghost.position) || 
-        ghost.position.x < 1 || ghost.position.x >= _gameWidth - 1 ||
-        ghost.position.y < 1 || ghost.position.y >= _gameHeight - 1) {
-        ghost.position = oldPos;
+    int junction = _maze.junctionAt(position.x, position.y);
+    if (junction >= 0) {
+        const Maze::Junction &node = _maze.getJunctions()[junction];
+        int choices[Maze::DIRECTION_COUNT];
+        int count = 0;
+        for (int d = 0; d < Maze::DIRECTION_COUNT; d++) {
+            if (node.next[d] >= 0 && d != Maze::opposite(direction)) {
+                choices[count++] = d;
+            }
+        }
+        for (int d = 0; count == 0 && d < Maze::DIRECTION_COUNT; d++) {
+            if (node.next[d] >= 0) {
+                choices[count++] = d;
+            }
+        }
+        if (count > 0) {
+            direction = choices[_random.below(count)];
+        }
+    } else {
+        uint8_t onward = _maze.exits(position.x, position.y) & ~(1 << Maze::opposite(direction));
+        if (onward) {
+            direction = __builtin_ctz(onward);
+        }
     }
+    _maze.step(position.x, position.y, direction);
+    cell = position.y * _gameWidth + position.x;
 }
 
-bool Pacman::isCollision(const Position& pos) {
-    return std::any_of(_walls.begin(), _walls.end(), 
-        [&pos](const Position& wall) {
-            return wall.x == pos.x && wall.y == pos.y;
-        });
+void Pacman::reportBenchmark() {
+    if (_benchmarkGhosts == 0 || _ghostTicks == 0) {
+        return;
+    }
+    std::cerr << "Pacman: " << _entities.ghostCount() << " ghosts on " << _gameWidth << "x" << _gameHeight
+              << ", " << _ghostTicks << " ghost ticks at " << (_ghostSeconds / _ghostTicks * 1e6) << " us"
+              << ", " << (_ghostSeconds > 0 ? _ghostSteps / _ghostSeconds / 1e6 : 0) << " M ghost steps/s, " << _kernelName << " kernels";
+    if (_fieldBuilds > 0) {
+        std::cerr << ", flow field rebuilt " << _fieldBuilds << " times at "
+                  << (_fieldSeconds / _fieldBuilds * 1e6) << " us";
+    }
+    std::cerr << std::endl;
+    _ghostTicks = 0;
+    _ghostSteps = 0;
+    _ghostSeconds = 0;
+    _fieldBuilds = 0;
+    _fieldSeconds = 0;
 }
 
 GameState Pacman::getState() const {
@@ -3,8 +3,14 @@
 
 #include "../../../src/interfaces/IGame.hpp"
 #include "../../../src/interfaces/IGraphical.hpp"
+#include "../../../src/interfaces/BuiltinMaps.hpp"
+#include "../../../src/interfaces/Grid.hpp"
+#include "../../../src/interfaces/Random.hpp"
+#include "Entities.hpp"
+#include "Maze.hpp"
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace arcade {
 
@@ -25,18 +31,42 @@ public:
     void setState(GameState state) override;
     std::string getName() const override;
     std::string getDescription() const override;
+    void snapshot(std::vector<uint8_t> &buffer) const override;
+    bool restore(const std::vector<uint8_t> &buffer) override;
 
 private:
-    struct Entity {
-        Position position;
-        Color color;
-        int speed;
-    };
-
-    Entity _pacman;
-    std::vector<Entity> _ghosts;
-    std::vector<Position> _dots;
-    std::vector<Position> _walls;
+    // Column kernels, picked for the CPU when the game is created.
+    using StepCells = void (*)(int *cells, size_t count, const int *next);
+    using FindCell = size_t (*)(const int *cells, size_t count, int cell);
+
+    // Maze side used by the ghost benchmark.
+    static constexpr int BENCHMARK_MAZE_SIZE = 256;
+    // Snapshot layout; bump the version whenever snapshot() changes.
+    static constexpr char SNAPSHOT_TAG[] = "PACM";
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    // Pacman and the ghosts; a ghost's direction is the Maze::Direction it
+    // keeps while wandering, until its next junction.
+    Entities _entities;
+    StepCells _stepCells;
+    FindCell _findCell;
+    std::string _kernelName;
+    // Compiled on the first init and kept across restarts.
+    Maze _maze;
+    // Remaining dots, one bit per cell.
+    GridLayer _dots;
+    size_t _dotCount;
+    // Shortest way to Pacman from every cell, shared by all ghosts.
+    FlowField _chase;
+    // Ghost count of the benchmark mode, 0 when playing normally.
+    size_t _benchmarkGhosts;
+    size_t _ghostSteps;
+    size_t _ghostTicks;
+    double _ghostSeconds;
+    size_t _fieldBuilds;
+    double _fieldSeconds;
+    // Wandering ghosts' turns; reseeded by every init().
+    Random _random;
     GameState _state;
     int _score;
     int _cellSize;
@@ -45,12 +75,17 @@ private:
     float _moveTimer;
     const float _moveInterval;
 
-    void moveGhost(Entity& ghost);
-    bool isCollision(const Position& pos);
+    void selectKernels();
+    Position cellPosition(int cell) const;
+    void wander(size_t ghost);
+    void moveGhosts();
+    void spawnGhosts();
+    void reportBenchmark();
     void updatePacmanPosition(EventType direction);
     void checkCollisions();
     void spawnDots();
-    void spawnWalls();
+    void loadMaze();
+    Position nearestCell(const Position &from, bool chasing) const;
 };
 
 extern "C" {
@@ -0,0 +1,335 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+namespace arcade {
+
+namespace {
+
+// Snakes a thread takes from the pass at a time.
+constexpr size_t BATCH = 64;
+// Room a respawned snake's body starts with; it doubles as it grows.
+constexpr size_t BODY_CAPACITY = 16;
+
+const int dx[4] = {0, 1, 0, -1};
+const int dy[4] = {-1, 0, 1, 0};
+
+}
+
+Arena::Arena(int snakes, unsigned threads, uint64_t seed)
+    : _current(0), _random(seed), _passId(0), _pass(DECIDE), _busyWorkers(0), _stopping(false),
+      _nextSnake(0), _ticks(0), _steps(0), _deaths(0), _seconds(0) {
+    snakes = std::max(snakes, 1);
+    int side = std::max(32, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(snakes) * CELLS_PER_SNAKE))));
+    _width = side;
+    _height = side;
+    for (auto &grid : _grids) {
+        grid.assign(static_cast<size_t>(_width) * _height, EMPTY);
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++) {
+                if (x == 0 || y == 0 || x == _width - 1 || y == _height - 1) {
+                    grid[index(x, y)] = WALL;
+                }
+            }
+        }
+    }
+    _claims = std::vector<std::atomic<uint32_t>>(_grids[0].size());
+    for (auto &claim : _claims) {
+        claim.store(EMPTY, std::memory_order_relaxed);
+    }
+
+    _snakes.resize(snakes);
+    for (size_t id = 0; id < _snakes.size(); id++) {
+        Snake &snake = _snakes[id];
+        snake.random = seed + 0x9E3779B97F4A7C15ull * (id + 1);
+        snake.direction = 0;
+        snake.growth = 0;
+        snake.alive = false;
+        snake.ate = false;
+        snake.target = -1;
+    }
+    // Spawning everyone and one piece of food per snake goes through the
+    // respawn path, so both grids get it on the first tick.
+    respawn();
+    for (size_t i = 0; i < _snakes.size(); i++) {
+        int cell = randomEmptyCell();
+        if (cell >= 0) {
+            write(cell, FOOD);
+        }
+    }
+    _deaths = 0;
+    _steps = 0;
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, static_cast<unsigned>((_snakes.size() + BATCH - 1) / BATCH));
+    // The calling thread works too, so it counts as one of them.
+    for (unsigned i = 1; i < threads; i++) {
+        _workers.emplace_back(&Arena::workerLoop, this);
+    }
+}
+
+Arena::~Arena() {
+    {
+        std::lock_guard<std::mutex> lock(_poolMutex);
+        _stopping = true;
+    }
+    _workReady.notify_all();
+    for (auto &worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+uint32_t Arena::cell(int x, int y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        return WALL;
+    }
+    return _grids[_current][index(x, y)];
+}
+
+// splitmix64: small, fast and good enough for steering snakes.
+uint64_t Arena::nextRandom(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void Arena::tick() {
+    auto start = std::chrono::steady_clock::now();
+
+    runPass(DECIDE);
+    std::vector<uint32_t> &next = _grids[_current ^ 1];
+    for (const auto &change : _spawnChanges) {
+        next[change.first] = change.second;
+    }
+    _spawnChanges.clear();
+    runPass(MOVE);
+    _current ^= 1;
+    respawn();
+
+    _ticks++;
+    _seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Arena::runPass(Pass pass) {
+    {
+        std::lock_guard<std::mutex> lock(_poolMutex);
+        _pass = pass;
+        _nextSnake.store(0, std::memory_order_relaxed);
+        _busyWorkers = static_cast<int>(_workers.size());
+        _passId++;
+    }
+    _workReady.notify_all();
+    work();
+    {
+        std::unique_lock<std::mutex> lock(_poolMutex);
+        _workDone.wait(lock, [this] { return _busyWorkers == 0; });
+    }
+}
+
+void Arena::workerLoop() {
+    uint64_t seenPass = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_poolMutex);
+            _workReady.wait(lock, [this, seenPass] { return _stopping || _passId != seenPass; });
+            if (_stopping) {
+                return;
+            }
+            seenPass = _passId;
+        }
+        work();
+        {
+            std::lock_guard<std::mutex> lock(_poolMutex);
+            if (--_busyWorkers == 0) {
+                _workDone.notify_one();
+            }
+        }
+    }
+}
+
+void Arena::work() {
+    size_t first;
+
+    while ((first = _nextSnake.fetch_add(BATCH, std::memory_order_relaxed)) < _snakes.size()) {
+        size_t last = std::min(first + BATCH, _snakes.size());
+        for (size_t id = first; id < last; id++) {
+            if (_pass == DECIDE) {
+                decide(id);
+            } else {
+                move(id);
+            }
+        }
+    }
+}
+
+// Replays the snake's last changes into the next grid, then picks a move
+// from the current one: food next to the head first, else an empty cell,
+// keeping straight unless the snake's generator says to turn.
+void Arena::decide(size_t id) {
+    Snake &snake = _snakes[id];
+    std::vector<uint32_t> &next = _grids[_current ^ 1];
+    for (const auto &change : snake.changes) {
+        next[change.first] = change.second;
+    }
+    snake.changes.clear();
+    snake.target = -1;
+    if (!snake.alive) {
+        return;
+    }
+
+    const std::vector<uint32_t> &grid = _grids[_current];
+    const Position &head = snake.body.head();
+    int order[3] = {snake.direction, (snake.direction + 1) % 4, (snake.direction + 3) % 4};
+    uint64_t random = nextRandom(snake.random);
+    if ((random & 7) == 0) {
+        std::swap(order[0], order[1 + ((random >> 3) & 1)]);
+    }
+    int best = -1;
+    for (int i = 0; i < 3; i++) {
+        uint32_t value = grid[index(head.x + dx[order[i]], head.y + dy[order[i]])];
+        if (value == FOOD) {
+            best = i;
+            break;
+        }
+        if (value == EMPTY && best < 0) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return;
+    }
+    snake.direction = order[best];
+    snake.target = static_cast<int>(index(head.x + dx[snake.direction], head.y + dy[snake.direction]));
+
+    std::atomic<uint32_t> &claim = _claims[snake.target];
+    uint32_t seen = claim.load(std::memory_order_relaxed);
+    while (id < seen && !claim.compare_exchange_weak(seen, static_cast<uint32_t>(id), std::memory_order_relaxed)) {
+    }
+}
+
+// The holder of a claim moves into it and resets it for the next tick;
+// a snake that lost its claim or had nowhere to go clears its body.
+void Arena::move(size_t id) {
+    Snake &snake = _snakes[id];
+    if (!snake.alive) {
+        return;
+    }
+    std::vector<uint32_t> &next = _grids[_current ^ 1];
+    if (snake.target < 0 || _claims[snake.target].load(std::memory_order_relaxed) != id) {
+        snake.body.forEach([&](const Position &segment) {
+            next[index(segment.x, segment.y)] = EMPTY;
+            snake.changes.emplace_back(static_cast<int>(index(segment.x, segment.y)), EMPTY);
+        });
+        snake.alive = false;
+        return;
+    }
+    _claims[snake.target].store(EMPTY, std::memory_order_relaxed);
+
+    if (_grids[_current][snake.target] == FOOD) {
+        snake.growth++;
+        snake.ate = true;
+    }
+    if (snake.growth > 0) {
+        snake.growth--;
+    } else {
+        int tail = static_cast<int>(index(snake.body.tail().x, snake.body.tail().y));
+        snake.body.popTail();
+        next[tail] = EMPTY;
+        snake.changes.emplace_back(tail, EMPTY);
+    }
+    snake.body.pushHead(Position(snake.target % _width, snake.target / _width));
+    next[snake.target] = static_cast<uint32_t>(id);
+    snake.changes.emplace_back(snake.target, static_cast<uint32_t>(id));
+}
+
+// Serial, in id order: food replaces what was eaten and dead snakes come
+// back at random empty cells.
+void Arena::respawn() {
+    for (size_t id = 0; id < _snakes.size(); id++) {
+        Snake &snake = _snakes[id];
+        if (snake.ate) {
+            snake.ate = false;
+            int cell = randomEmptyCell();
+            if (cell >= 0) {
+                write(cell, FOOD);
+            }
+        }
+        if (snake.alive) {
+            _steps++;
+            continue;
+        }
+        int cell = randomEmptyCell();
+        if (cell < 0) {
+            continue;
+        }
+        _deaths++;
+        snake.body.reset(BODY_CAPACITY, Position(cell % _width, cell / _width));
+        snake.growth = SPAWN_LENGTH - 1;
+        snake.direction = static_cast<int>(nextRandom(_random) % 4);
+        snake.alive = true;
+        write(cell, static_cast<uint32_t>(id));
+    }
+}
+
+// A random empty cell, or -1 when the board has none.
+int Arena::randomEmptyCell() {
+    const std::vector<uint32_t> &grid = _grids[_current];
+    for (int attempt = 0; attempt < 64; attempt++) {
+        size_t cell = nextRandom(_random) % grid.size();
+        if (grid[cell] == EMPTY) {
+            return static_cast<int>(cell);
+        }
+    }
+    size_t start = nextRandom(_random) % grid.size();
+    for (size_t i = 0; i < grid.size(); i++) {
+        size_t cell = (start + i) % grid.size();
+        if (grid[cell] == EMPTY) {
+            return static_cast<int>(cell);
+        }
+    }
+    return -1;
+}
+
+// A serial change to the current grid, replayed into the other one during
+// the next tick.
+void Arena::write(int cell, uint32_t value) {
+    _grids[_current][cell] = value;
+    _spawnChanges.emplace_back(cell, value);
+}
+
+uint64_t Arena::checksum() const {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](uint64_t value) {
+        hash = (hash ^ value) * 0x100000001B3ull;
+    };
+    for (uint32_t value : _grids[_current]) {
+        mix(value);
+    }
+    for (const Snake &snake : _snakes) {
+        mix(snake.body.size());
+        mix(static_cast<uint64_t>(snake.direction));
+        mix(static_cast<uint64_t>(snake.growth));
+        mix(snake.alive);
+    }
+    return hash;
+}
+
+void Arena::report(std::ostream &out) const {
+    if (_ticks == 0) {
+        return;
+    }
+    out << "Snake arena: " << _snakes.size() << " snakes on " << _width << "x" << _height << ", "
+        << threadCount() << " threads, " << _ticks << " ticks at " << (_seconds / _ticks * 1e6) << " us"
+        << ", " << (_seconds > 0 ? _steps / _seconds / 1e6 : 0) << " M snake steps/s, "
+        << _deaths << " deaths, checksum " << std::hex << checksum() << std::dec << std::endl;
+}
+
+}
@@ -0,0 +1,119 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include "../../../src/interfaces/IGraphical.hpp"
+#include "../../../src/interfaces/SnakeBody.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace arcade {
+
+// Thousands of AI snakes on one walled board, the stress workload of the
+// Snake plugin. The board is an occupancy grid holding, per cell, the id of
+// the snake on it or one of the EMPTY, WALL and FOOD values, kept twice:
+// a tick reads the current grid and writes the next one.
+//
+// A tick runs in two parallel passes over the snakes. The first brings the
+// next grid up to date with the previous tick's changes and has every
+// snake choose its move from the current grid, claiming its target cell
+// with an atomic minimum. The second moves the snake holding each claim
+// (the lowest id) and kills the others, as well as snakes heading into a
+// wall or a body; every write lands in cells owned by that snake alone.
+// Respawning dead snakes and eaten food then happens on one thread, in id
+// order, from the arena's own generator. Nothing depends on how the snakes
+// are split between threads, so a seed gives the same game for any thread
+// count, which checksum() lets a run confirm.
+class Arena {
+public:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+    static constexpr uint32_t WALL = 0xFFFFFFFE;
+    static constexpr uint32_t FOOD = 0xFFFFFFFD;
+    // Board cells per snake, which sets the arena side.
+    static constexpr int CELLS_PER_SNAKE = 256;
+    static constexpr int SPAWN_LENGTH = 5;
+
+    // threads counts the calling thread; 0 uses every core.
+    Arena(int snakes, unsigned threads, uint64_t seed);
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void tick();
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    uint32_t cell(int x, int y) const;
+    size_t snakeCount() const { return _snakes.size(); }
+    const SnakeBody &body(size_t id) const { return _snakes[id].body; }
+    unsigned threadCount() const { return static_cast<unsigned>(_workers.size()) + 1; }
+    uint64_t ticks() const { return _ticks; }
+
+    // Hash of the board and every snake, equal across thread counts.
+    uint64_t checksum() const;
+    void report(std::ostream &out) const;
+
+private:
+    struct Snake {
+        SnakeBody body;
+        int direction;
+        int growth;
+        uint64_t random;
+        bool alive;
+        bool ate;
+        // Cell the snake claimed this tick, -1 when it crashes instead.
+        int target;
+        // Cells it changed last tick, replayed into the other grid.
+        std::vector<std::pair<int, uint32_t>> changes;
+    };
+
+    enum Pass {
+        DECIDE,
+        MOVE
+    };
+
+    int _width;
+    int _height;
+    std::vector<uint32_t> _grids[2];
+    int _current;
+    std::vector<std::atomic<uint32_t>> _claims;
+    std::vector<Snake> _snakes;
+    // Cells changed by the serial respawns, replayed like a snake's.
+    std::vector<std::pair<int, uint32_t>> _spawnChanges;
+    uint64_t _random;
+
+    std::vector<std::thread> _workers;
+    std::mutex _poolMutex;
+    std::condition_variable _workReady;
+    std::condition_variable _workDone;
+    uint64_t _passId;
+    Pass _pass;
+    int _busyWorkers;
+    bool _stopping;
+    std::atomic<size_t> _nextSnake;
+
+    uint64_t _ticks;
+    uint64_t _steps;
+    uint64_t _deaths;
+    double _seconds;
+
+    size_t index(int x, int y) const { return static_cast<size_t>(y) * _width + x; }
+    static uint64_t nextRandom(uint64_t &state);
+
+    void runPass(Pass pass);
+    void workerLoop();
+    void work();
+    void decide(size_t id);
+    void move(size_t id);
+    void respawn();
+    int randomEmptyCell();
+    void write(int cell, uint32_t value);
+};
+
+}
+
+#endif
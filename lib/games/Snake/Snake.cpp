@@ -1,30 +1,75 @@
 #include "Snake.hpp"
 #include <cstdlib>
-#include <ctime>
 #include <algorithm>
+#include <chrono>
+#include <iostream>
 #include "../../../src/interfaces/MapLoader.hpp"
+#include "../../../src/interfaces/Snapshot.hpp"
 
 namespace arcade {
 
+// ARCADE_SNAKE_ARENA=<count> turns the game into an arena of that many AI
+// snakes, ticked by ARCADE_ARENA_THREADS threads (every core by default).
+static int arenaSnakes() {
+    const char *count = std::getenv("ARCADE_SNAKE_ARENA");
+    return count ? std::max(0, std::atoi(count)) : 0;
+}
+
+static unsigned arenaThreads() {
+    const char *threads = std::getenv("ARCADE_ARENA_THREADS");
+    return threads ? static_cast<unsigned>(std::max(1, std::atoi(threads))) : 0;
+}
+
 Snake::Snake() 
-    : _state(GameState::MENU), _score(0), _cellSize(20), _gridWidth(20), _gridHeight(20), _timeAccumulator(0.0f), _moveInterval(0.2f) {
-    srand(time(nullptr));
+    : _growth(0), _state(GameState::MENU), _score(0), _cellSize(20), _gridWidth(DEFAULT_GRID_WIDTH), _gridHeight(DEFAULT_GRID_HEIGHT), _timeAccumulator(0.0f), _moveInterval(0.2f),
+      _worldWidth(0), _worldHeight(0), _arenaSnakes(arenaSnakes()) {
+    _hugeWorld = World::sizeFromEnvironment(_worldWidth, _worldHeight);
 }
 
 void Snake::init() {
-    _snake.clear();
-    _snake.push_back({Position(_gridWidth / 2, _gridHeight / 2)});
     _direction = Position(0, 0);
-    loadMapForLevel(1);
+    _score = 0;
+    uint64_t seed = ARENA_SEED;
+    if (!Random::seedFromEnvironment(seed) && _arenaSnakes == 0) {
+        seed = Random::sessionSeed();
+    }
+    _random.seed(seed);
+    if (_arenaSnakes > 0) {
+        _arena = std::make_unique<Arena>(_arenaSnakes, arenaThreads(), seed);
+        _state = GameState::PLAYING;
+        return;
+    }
+    if (_hugeWorld) {
+        Position start(_worldWidth / 2, _worldHeight / 2);
+        _world = std::make_unique<World>(_worldWidth, _worldHeight, _random(), 0, start);
+        _snake.reset(World::BODY_CAPACITY, start);
+    } else {
+        loadMapForLevel(1);
+        _snake.reset(static_cast<size_t>(_grid.getWidth()) * _grid.getHeight() + 1,
+                     Position(_gridWidth / 2, _gridHeight / 2));
+    }
+    _growth = 0;
+    const Position &head = _snake.head();
+    if (_world) {
+        _world->bodies().set(head.x, head.y);
+    } else {
+        _grid.bodies().set(head.x, head.y);
+        _free.rebuild(_grid, head.x, head.y);
+    }
     spawnFood();
     _state = GameState::PLAYING;
-    _score = 0;
     _timeAccumulator = 0.0f;
     _moveInterval = 0.2f;
 }
 
 void Snake::stop() {
     _state = GameState::MENU;
+    if (_world) {
+        _world->report(std::cerr, "Snake");
+    }
+    if (_arena) {
+        _arena->report(std::cerr);
+    }
 }
 
 void Snake::restart() {
@@ -32,6 +77,10 @@ void Snake::restart() {
 }
 
 void Snake::update(float deltaTime) {
+    if (_arena && _state == GameState::PLAYING) {
+        _arena->tick();
+        return;
+    }
     if (_state != GameState::PLAYING || (_direction.x == 0 && _direction.y == 0)) {
         return;
     }
@@ -39,38 +88,111 @@ void Snake::update(float deltaTime) {
     _timeAccumulator += deltaTime;
     if (_timeAccumulator >= _moveInterval) {
         _timeAccumulator -= _moveInterval;
-        moveSnake();
-
-        if (checkCollision()) {
+        if (!moveSnake()) {
             _state = GameState::GAME_OVER;
             return;
         }
 
-        if (_snake.front().position.x == _food.x && _snake.front().position.y == _food.y) {
+        const Position &head = _snake.head();
+        if (_world) {
+            _world->follow(head);
+            if (_world->hasItem(head.x, head.y)) {
+                _world->items().reset(head.x, head.y);
+                _score += 10;
+                _growth++;
+                spawnFood();
+            }
+        } else if (_grid.hasItem(head.x, head.y)) {
+            _grid.items().reset(head.x, head.y);
             _score += 10;
-            _snake.push_back({_snake.back().position});
+            _growth++;
             spawnFood();
         }
     }
 }
 
 void Snake::render(IGraphical &graphical) {
+    if (_world) {
+        renderWorld(graphical);
+        return;
+    }
+    if (_arena) {
+        renderArena(graphical);
+        return;
+    }
     graphical.clear();
     graphical.setCellSize(_cellSize);
 
-    for (const auto& wall : _walls) {
-        graphical.drawCell(wall.x, wall.y, Color(128, 128, 128));
-    }
+    _grid.walls().forEach([&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(128, 128, 128));
+    });
 
-    for (const auto &segment : _snake) {
-        graphical.drawCell(segment.position.x, segment.position.y, Color(0, 255, 0));
-    }
+    _snake.forEach([&graphical](const Position &segment) {
+        graphical.drawCell(segment.x, segment.y, Color(0, 255, 0));
+    });
 
     graphical.drawCell(_food.x, _food.y, Color(255, 0, 0));
     graphical.drawText(Text("Score: " + std::to_string(_score), Position(10, 10), Color(255, 255, 255), 16));
     graphical.display();
 }
 
+// Draws the view around the head: only the chunks under it are walked, and
+// food off screen is shown dimmed at the edge nearest to it.
+void Snake::renderWorld(IGraphical &graphical) {
+    auto start = std::chrono::steady_clock::now();
+    graphical.clear();
+    graphical.setCellSize(_cellSize);
+
+    _world->forEachVisible(_world->walls(), [&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(128, 128, 128));
+    });
+    _world->forEachVisible(_world->bodies(), [&graphical](int x, int y) {
+        graphical.drawCell(x, y, Color(0, 255, 0));
+    });
+
+    int foodX = std::clamp(_food.x - _world->viewLeft(), 0, _world->viewWidth() - 1);
+    int foodY = std::clamp(_food.y - _world->viewTop(), 0, _world->viewHeight() - 1);
+    graphical.drawCell(foodX, foodY, _world->inView(_food.x, _food.y) ? Color(255, 0, 0) : Color(128, 0, 0));
+    graphical.drawText(Text("Score: " + std::to_string(_score), Position(10, 10), Color(255, 255, 255), 16));
+    _world->addFrame(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    graphical.display();
+}
+
+// Draws the part of the arena around snake 0, which is green like the
+// player's snake; the others get a colour from their id.
+void Snake::renderArena(IGraphical &graphical) {
+    graphical.clear();
+    graphical.setCellSize(_cellSize);
+
+    int viewWidth = std::min(World::VIEW_WIDTH, _arena->getWidth());
+    int viewHeight = std::min(World::VIEW_HEIGHT, _arena->getHeight());
+    const Position &focus = _arena->body(0).head();
+    int left = std::clamp(focus.x - viewWidth / 2, 0, _arena->getWidth() - viewWidth);
+    int top = std::clamp(focus.y - viewHeight / 2, 0, _arena->getHeight() - viewHeight);
+    for (int y = 0; y < viewHeight; y++) {
+        for (int x = 0; x < viewWidth; x++) {
+            uint32_t cell = _arena->cell(left + x, top + y);
+            if (cell == Arena::EMPTY) {
+                continue;
+            }
+            if (cell == Arena::WALL) {
+                graphical.drawCell(x, y, Color(128, 128, 128));
+            } else if (cell == Arena::FOOD) {
+                graphical.drawCell(x, y, Color(255, 0, 0));
+            } else if (cell == 0) {
+                graphical.drawCell(x, y, Color(0, 255, 0));
+            } else {
+                graphical.drawCell(x, y, Color(64 + cell * 37 % 160, 64 + cell * 91 % 160, 224));
+            }
+        }
+    }
+
+    graphical.drawText(Text("Tick: " + std::to_string(_arena->ticks()), Position(10, 10), Color(255, 255, 255), 16));
+    graphical.drawText(Text("Length: " + std::to_string(_arena->body(0).size()), Position(10, 30),
+                            Color(255, 255, 255), 16));
+    graphical.display();
+}
+
 void Snake::handleEvent(EventType event) {
     if (_state != GameState::PLAYING) return;
 
@@ -100,51 +222,59 @@ void Snake::handleEvent(EventType event) {
     }
 }
 
+// Picks uniformly among the free cells the snake can reach; once the body
+// fills all of them the game is won. A huge world has no free-cell index,
+// so food goes to a free cell of the view instead.
 void Snake::spawnFood() {
-    bool validPosition;
-    do {
-        _food.x = 1 + rand() % (_gridWidth - 2);
-        _food.y = 1 + rand() % (_gridHeight - 2);
-        
-        validPosition = true;
-        
-        if (isWall(_food.x, _food.y)) {
-            validPosition = false;
-            continue;
-        }
-        
-        for (const auto &segment : _snake) {
-            if (segment.position.x == _food.x && segment.position.y == _food.y) {
-                validPosition = false;
-                break;
-            }
+    if (_world) {
+        if (!_world->sampleFree(_random, _food.x, _food.y)) {
+            _state = GameState::WIN;
+            return;
         }
-    } while (!validPosition);
+        _world->items().set(_food.x, _food.y);
+        return;
+    }
+    if (_free.empty()) {
+        _state = GameState::WIN;
+        return;
+    }
+    _free.sample(_random(), _food.x, _food.y);
+    _free.erase(_food.x, _food.y);
+    _grid.items().set(_food.x, _food.y);
 }
 
-void Snake::moveSnake() {
-    Position newHead = _snake.front().position;
+// Moves the head one cell and reports whether it survived. The tail leaves
+// its cell before the head is tested, so following the tail is allowed;
+// while growth is pending the tail stays put instead.
+bool Snake::moveSnake() {
+    Position newHead = _snake.head();
     newHead.x += _direction.x;
     newHead.y += _direction.y;
 
-    _snake.push_front({newHead});
-    _snake.pop_back();
-}
-
-bool Snake::checkCollision() {
-    const auto &head = _snake.front().position;
-
-    if (isWall(head.x, head.y)) {
-        return true;
-    }
-
-    for (size_t i = 1; i < _snake.size(); ++i) {
-        if (_snake[i].position.x == head.x && _snake[i].position.y == head.y) {
-            return true;
+    if (_growth > 0) {
+        _growth--;
+    } else {
+        Position tail = _snake.tail();
+        _snake.popTail();
+        if (_world) {
+            _world->bodies().reset(tail.x, tail.y);
+        } else {
+            _grid.bodies().reset(tail.x, tail.y);
+            _free.insert(tail.x, tail.y);
         }
     }
 
-    return false;
+    if (_world) {
+        bool collided = _world->isBlocked(newHead.x, newHead.y);
+        _snake.pushHead(newHead);
+        _world->bodies().set(newHead.x, newHead.y);
+        return !collided;
+    }
+    bool collided = _grid.isBlocked(newHead.x, newHead.y);
+    _snake.pushHead(newHead);
+    _grid.bodies().set(newHead.x, newHead.y);
+    _free.erase(newHead.x, newHead.y);
+    return !collided;
 }
 
 GameState Snake::getState() const {
@@ -167,41 +297,149 @@ std::string Snake::getDescription() const {
     return "Classic Snake game where you eat food and grow longer.";
 }
 
+Snake::SnapshotMode Snake::snapshotMode() const {
+    return _arenaSnakes > 0 ? ARENA_SNAPSHOT : _hugeWorld ? WORLD_SNAPSHOT : GRID_SNAPSHOT;
+}
+
+// The play state, the body and the generator, then the world's seed or the
+// free-cell order. Walls are not copied: they come from the level map (or
+// the world seed), which restore() reloads only if this instance has none.
+// An arena is too large to copy each tick and writes only its mode, which
+// restore() refuses.
+void Snake::snapshot(std::vector<uint8_t> &buffer) const {
+    SnapshotWriter out(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    SnapshotMode mode = snapshotMode();
+    out.put(mode);
+    if (mode == ARENA_SNAPSHOT) {
+        return;
+    }
+    bool food = _world ? _world->hasItem(_food.x, _food.y) : _grid.hasItem(_food.x, _food.y);
+    out.put(_state);
+    out.put(_score);
+    out.put(_growth);
+    out.put(_food);
+    out.put(food);
+    out.put(_direction);
+    out.put(_timeAccumulator);
+    out.put(_moveInterval);
+    out.put(_random);
+    _snake.save(out);
+    if (_world) {
+        out.put(_world->getWidth());
+        out.put(_world->getHeight());
+        out.put(_world->getSeed());
+        out.put(_world->getStart());
+    } else {
+        out.putArray(_free.cells());
+    }
+}
+
+bool Snake::restore(const std::vector<uint8_t> &buffer) {
+    SnapshotReader in(buffer, SNAPSHOT_TAG, SNAPSHOT_VERSION);
+    SnapshotMode mode = GRID_SNAPSHOT;
+    GameState state = GameState::MENU;
+    int score = 0;
+    int growth = 0;
+    Position food;
+    bool hasFood = false;
+    Position direction;
+    float timeAccumulator = 0.0f;
+    float moveInterval = 0.0f;
+    Random random;
+    std::vector<Position> segments;
+    int worldWidth = 0;
+    int worldHeight = 0;
+    uint32_t worldSeed = 0;
+    Position worldStart;
+    std::vector<int> freeCells;
+
+    in.get(mode);
+    if (mode != snapshotMode() || mode == ARENA_SNAPSHOT) {
+        return false;
+    }
+    in.get(state);
+    in.get(score);
+    in.get(growth);
+    in.get(food);
+    in.get(hasFood);
+    in.get(direction);
+    in.get(timeAccumulator);
+    in.get(moveInterval);
+    in.get(random);
+    in.getArray(segments);
+    if (mode == WORLD_SNAPSHOT) {
+        in.get(worldWidth);
+        in.get(worldHeight);
+        in.get(worldSeed);
+        in.get(worldStart);
+    } else {
+        in.getArray(freeCells);
+    }
+    if (!in.complete() || segments.empty()) {
+        return false;
+    }
+
+    if (mode == WORLD_SNAPSHOT) {
+        if (!_world || _world->getWidth() != worldWidth || _world->getHeight() != worldHeight
+            || _world->getSeed() != worldSeed || _world->getStart().x != worldStart.x
+            || _world->getStart().y != worldStart.y) {
+            _world = std::make_unique<World>(worldWidth, worldHeight, worldSeed, 0, worldStart);
+        }
+        _world->bodies().clear();
+        _world->items().clear();
+        _snake.assign(World::BODY_CAPACITY, segments.data(), segments.size());
+        for (const Position &segment : segments) {
+            _world->bodies().set(segment.x, segment.y);
+        }
+        if (hasFood) {
+            _world->items().set(food.x, food.y);
+        }
+        _world->follow(segments.front());
+    } else {
+        if (_grid.getWidth() == 0) {
+            loadMapForLevel(1);
+        }
+        _grid.bodies().clear();
+        _grid.items().clear();
+        _snake.assign(static_cast<size_t>(_grid.getWidth()) * _grid.getHeight() + 1, segments.data(), segments.size());
+        for (const Position &segment : segments) {
+            _grid.bodies().set(segment.x, segment.y);
+        }
+        if (hasFood) {
+            _grid.items().set(food.x, food.y);
+        }
+        // Any listed cell lies in the region the index was built over.
+        int start = freeCells.empty() ? -1 : freeCells.front();
+        _free.rebuild(_grid, start >= 0 ? start % _grid.getWidth() : segments.front().x,
+                      start >= 0 ? start / _grid.getWidth() : segments.front().y);
+        _free.assignCells(freeCells);
+    }
+    _state = state;
+    _score = score;
+    _growth = growth;
+    _food = food;
+    _direction = direction;
+    _timeAccumulator = timeAccumulator;
+    _moveInterval = moveInterval;
+    _random = random;
+    return true;
+}
+
 void Snake::loadMapForLevel(int level) {
     try {
         std::string mapFile = "assets/maps/snake/level" + std::to_string(level) + ".txt";
-        _currentMap = MapLoader::loadMap(mapFile);
-        
-        _walls.clear();
-        for (size_t y = 0; y < _currentMap.size(); ++y) {
-            for (size_t x = 0; x < _currentMap[y].size(); ++x) {
-                if (_currentMap[y][x] == '#') {
-                    _walls.push_back({static_cast<int>(x), static_cast<int>(y)});
-                }
-            }
-        }
+        _currentMap = MapLoader::load(mapFile);
+        _grid.resize(std::max(_gridWidth, _currentMap->width), std::max(_gridHeight, _currentMap->height));
+        _currentMap->stampWalls(_grid.walls());
     } catch (const std::exception& e) {
         initializeWalls();
     }
 }
 
 void Snake::initializeWalls() {
-    _walls.clear();
-    for (int x = 0; x < _gridWidth; ++x) {
-        _walls.push_back({x, 0});
-        _walls.push_back({x, _gridHeight - 1});
-    }
-    for (int y = 0; y < _gridHeight; ++y) {
-        _walls.push_back({0, y});
-        _walls.push_back({_gridWidth - 1, y});
-    }
-}
-
-bool Snake::isWall(int x, int y) const {
-    return std::find_if(_walls.begin(), _walls.end(),
-        [x, y](const Position& wall) {
-            return wall.x == x && wall.y == y;
-        }) != _walls.end();
+    static constexpr auto border = borderMap<DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT>();
+    _grid.resize(border.WIDTH, border.HEIGHT);
+    border.stampWalls(_grid.walls());
 }
 
 extern "C" {
@@ -3,7 +3,13 @@
 
 #include "../../../src/interfaces/IGame.hpp"
 #include "../../../src/interfaces/IGraphical.hpp"
-#include <deque>
+#include "../../../src/interfaces/BuiltinMaps.hpp"
+#include "../../../src/interfaces/Grid.hpp"
+#include "../../../src/interfaces/MapFile.hpp"
+#include "../../../src/interfaces/Random.hpp"
+#include "../../../src/interfaces/SnakeBody.hpp"
+#include "../../../src/interfaces/World.hpp"
+#include "Arena.hpp"
 #include <vector>
 #include <memory>
 
@@ -26,13 +32,27 @@ public:
     void setState(GameState state) override;
     std::string getName() const override;
     std::string getDescription() const override;
+    void snapshot(std::vector<uint8_t> &buffer) const override;
+    bool restore(const std::vector<uint8_t> &buffer) override;
 
 private:
-    struct Segment {
-        Position position;
+    // Board used when no level map can be loaded.
+    static constexpr int DEFAULT_GRID_WIDTH = 20;
+    static constexpr int DEFAULT_GRID_HEIGHT = 20;
+    // Arenas start from this seed unless ARCADE_SEED says otherwise, so
+    // runs can be compared.
+    static constexpr uint64_t ARENA_SEED = 1;
+    // Snapshot layout; bump the version whenever snapshot() changes.
+    static constexpr char SNAPSHOT_TAG[] = "SNAK";
+    static constexpr uint32_t SNAPSHOT_VERSION = 1;
+    enum SnapshotMode : uint8_t {
+        GRID_SNAPSHOT,
+        WORLD_SNAPSHOT,
+        ARENA_SNAPSHOT
     };
 
-    std::deque<Segment> _snake;
+    SnakeBody _snake;
+    int _growth;
     Position _food;
     Position _direction;
     GameState _state;
@@ -42,14 +62,28 @@ private:
     int _gridHeight;
     float _timeAccumulator;
     float _moveInterval;
-    std::vector<std::string> _currentMap;
-    std::vector<Position> _walls;
+    std::shared_ptr<const CompiledMap> _currentMap;
+    Grid _grid;
+    FreeCells _free;
+    // Food placement and world layout; reseeded by every init().
+    Random _random;
+    // Huge-world mode (ARCADE_WORLD_SIZE): the board is _world, created by
+    // init(), and _grid and _free stay empty.
+    bool _hugeWorld;
+    int _worldWidth;
+    int _worldHeight;
+    std::unique_ptr<World> _world;
+    // Arena mode (ARCADE_SNAKE_ARENA): AI snakes only, one tick per
+    // update, and the view follows snake 0.
+    int _arenaSnakes;
+    std::unique_ptr<Arena> _arena;
+    SnapshotMode snapshotMode() const;
     void loadMapForLevel(int level);
     void initializeWalls();
-    bool isWall(int x, int y) const;
     void spawnFood();
-    void moveSnake();
-    bool checkCollision();
+    bool moveSnake();
+    void renderWorld(IGraphical &graphical);
+    void renderArena(IGraphical &graphical);
 };
 
 } // namespace arcade
@@ -0,0 +1,519 @@
+#include "ANSI.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace arcade {
+
+namespace {
+
+volatile sig_atomic_t g_resizePending = 0;
+struct sigaction g_previousWinch;
+
+void onWinch(int sig) {
+    (void)sig;
+    g_resizePending = 1;
+}
+
+char *appendString(char *out, const char *str, size_t len) {
+    std::memcpy(out, str, len);
+    return out + len;
+}
+
+char *appendNumber(char *out, unsigned int value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+int numberLength(unsigned int value) {
+    int length = 1;
+    while (value >= 10) {
+        value /= 10;
+        length++;
+    }
+    return length;
+}
+
+uint8_t nearestPaletteColor(int r, int g, int b) {
+    static const int levels[6] = {0, 95, 135, 175, 215, 255};
+    auto nearestLevel = [](int value) {
+        int best = 0;
+        for (int i = 1; i < 6; ++i) {
+            if (std::abs(levels[i] - value) < std::abs(levels[best] - value)) {
+                best = i;
+            }
+        }
+        return best;
+    };
+    auto distance = [r, g, b](int cr, int cg, int cb) {
+        return (r - cr) * (r - cr) + (g - cg) * (g - cg) + (b - cb) * (b - cb);
+    };
+
+    int ri = nearestLevel(r);
+    int gi = nearestLevel(g);
+    int bi = nearestLevel(b);
+    int cubeDistance = distance(levels[ri], levels[gi], levels[bi]);
+
+    int grayIndex = std::max(0, std::min(23, ((r + g + b) / 3 - 8 + 5) / 10));
+    int gray = 8 + grayIndex * 10;
+    if (distance(gray, gray, gray) < cubeDistance) {
+        return static_cast<uint8_t>(232 + grayIndex);
+    }
+    return static_cast<uint8_t>(16 + ri * 36 + gi * 6 + bi);
+}
+
+}
+
+ANSIGraphical::ANSIGraphical() :
+    _isRunning(false),
+    _columns(0),
+    _rows(0),
+    _cellSize(20),
+    _fullRedraw(true),
+    _savedTermios(),
+    _inputStart(0),
+    _inputEnd(0),
+    _escapePending(false),
+    _lastFrameBytes(0),
+    _totalFrameBytes(0),
+    _peakFrameBytes(0),
+    _frameCount(0) {
+    _paletteLut.resize(LUT_LEVELS * LUT_LEVELS * LUT_LEVELS);
+    for (int r = 0; r < LUT_LEVELS; ++r) {
+        for (int g = 0; g < LUT_LEVELS; ++g) {
+            for (int b = 0; b < LUT_LEVELS; ++b) {
+                _paletteLut[(r * LUT_LEVELS + g) * LUT_LEVELS + b] = nearestPaletteColor(
+                    r * 255 / (LUT_LEVELS - 1), g * 255 / (LUT_LEVELS - 1), b * 255 / (LUT_LEVELS - 1));
+            }
+        }
+    }
+}
+
+ANSIGraphical::~ANSIGraphical() {
+    if (_isRunning) {
+        close();
+    }
+}
+
+void ANSIGraphical::init(int width, int height, const std::string &title) {
+    (void)width;
+    (void)height;
+    (void)title;
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        throw std::runtime_error("ANSI backend requires a terminal");
+    }
+    if (tcgetattr(STDIN_FILENO, &_savedTermios) < 0) {
+        throw std::runtime_error("Failed to read terminal attributes");
+    }
+    struct termios raw = _savedTermios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_iflag &= ~(IXON | ICRNL);
+    // read() returns at once with whatever is there. The descriptor itself
+    // stays blocking: O_NONBLOCK would be set on the tty's shared open file
+    // description, and so on stdout too.
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) < 0) {
+        throw std::runtime_error("Failed to enter raw terminal mode");
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = onWinch;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGWINCH, &action, &g_previousWinch);
+
+    // Alternate screen, hidden cursor, no autowrap so the last cell of the
+    // last row never scrolls the screen.
+    static const char enter[] = "\x1b[?1049h\x1b[?25l\x1b[?7l";
+    writeAll(enter, sizeof(enter) - 1);
+
+    _inputStart = 0;
+    _inputEnd = 0;
+    _escapePending = false;
+    _lastFrameBytes = 0;
+    _totalFrameBytes = 0;
+    _peakFrameBytes = 0;
+    _frameCount = 0;
+    resize();
+    _isRunning = true;
+}
+
+void ANSIGraphical::close() {
+    if (!_isRunning) return;
+
+    _isRunning = false;
+    static const char leave[] = "\x1b[0m\x1b[2J\x1b[?7h\x1b[?25h\x1b[?1049l";
+    writeAll(leave, sizeof(leave) - 1);
+    sigaction(SIGWINCH, &g_previousWinch, nullptr);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &_savedTermios);
+    if (_frameCount > 0) {
+        std::cerr << "ANSI: " << _frameCount << " frames, "
+                  << (_totalFrameBytes / _frameCount) << " bytes/frame average, "
+                  << _peakFrameBytes << " bytes peak" << std::endl;
+    }
+}
+
+bool ANSIGraphical::isOpen() const {
+    return _isRunning;
+}
+
+void ANSIGraphical::resize() {
+    struct winsize size;
+
+    g_resizePending = 0;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        _rows = size.ws_row;
+        _columns = size.ws_col;
+    } else {
+        _rows = 24;
+        _columns = 80;
+    }
+    size_t cells = static_cast<size_t>(_rows) * _columns;
+    _front.assign(cells, Cell{' ', DEFAULT_FG, DEFAULT_BG});
+    _back.assign(cells, Cell{' ', DEFAULT_FG, DEFAULT_BG});
+    _output.resize(cells * MAX_BYTES_PER_CELL + 64);
+    _fullRedraw = true;
+}
+
+void ANSIGraphical::clear() {
+    if (g_resizePending) {
+        resize();
+    }
+    std::fill(_back.begin(), _back.end(), Cell{' ', DEFAULT_FG, DEFAULT_BG});
+}
+
+void ANSIGraphical::display() {
+    char *out = _output.data();
+    int cursorX = -1;
+    int cursorY = -1;
+    int currentFg = -1;
+    int currentBg = -1;
+
+    if (_fullRedraw) {
+        static const char reset[] = "\x1b[0m\x1b[2J";
+        out = appendString(out, reset, sizeof(reset) - 1);
+        // Whatever the terminal shows now is blank; make every non-blank
+        // cell differ from the front buffer.
+        std::fill(_front.begin(), _front.end(), Cell{' ', DEFAULT_FG, DEFAULT_BG});
+        currentFg = -1;
+        currentBg = -1;
+        _fullRedraw = false;
+    }
+
+    for (int y = 0; y < _rows; ++y) {
+        const Cell *backRow = &_back[y * _columns];
+        Cell *frontRow = &_front[y * _columns];
+        for (int x = 0; x < _columns; ++x) {
+            const Cell &cell = backRow[x];
+            if (cell == frontRow[x]) {
+                continue;
+            }
+
+            if (y != cursorY || x != cursorX) {
+                int gap = x - cursorX;
+                bool sameRow = y == cursorY && gap > 0;
+                bool reprint = sameRow && gap <= 3;
+                for (int i = cursorX; reprint && i < x; ++i) {
+                    reprint = backRow[i].fg == currentFg && backRow[i].bg == currentBg;
+                }
+                if (reprint) {
+                    // Re-sending a few unchanged glyphs is cheaper than a move.
+                    for (int i = cursorX; i < x; ++i) {
+                        *out++ = backRow[i].ch;
+                    }
+                } else if (sameRow && 3 + numberLength(gap) < 4 + numberLength(y + 1) + numberLength(x + 1)) {
+                    out = appendString(out, "\x1b[", 2);
+                    out = appendNumber(out, gap);
+                    *out++ = 'C';
+                } else {
+                    out = appendString(out, "\x1b[", 2);
+                    out = appendNumber(out, y + 1);
+                    *out++ = ';';
+                    out = appendNumber(out, x + 1);
+                    *out++ = 'H';
+                }
+            }
+
+            if (cell.fg != currentFg || cell.bg != currentBg) {
+                out = appendString(out, "\x1b[", 2);
+                if (cell.fg != currentFg) {
+                    out = appendString(out, "38;5;", 5);
+                    out = appendNumber(out, cell.fg);
+                    if (cell.bg != currentBg) {
+                        *out++ = ';';
+                    }
+                }
+                if (cell.bg != currentBg) {
+                    out = appendString(out, "48;5;", 5);
+                    out = appendNumber(out, cell.bg);
+                }
+                *out++ = 'm';
+                currentFg = cell.fg;
+                currentBg = cell.bg;
+            }
+
+            *out++ = cell.ch;
+            frontRow[x] = cell;
+            cursorY = y;
+            cursorX = x + 1 < _columns ? x + 1 : -1;
+        }
+    }
+
+    size_t size = out - _output.data();
+    if (size > 0) {
+        writeAll(_output.data(), size);
+    }
+    _lastFrameBytes = size;
+    _totalFrameBytes += size;
+    _peakFrameBytes = std::max(_peakFrameBytes, size);
+    _frameCount++;
+}
+
+size_t ANSIGraphical::getLastFrameBytes() const {
+    return _lastFrameBytes;
+}
+
+// Blocks until the terminal took everything. Should stdout have been made
+// non-blocking by someone else, waits for room instead of spinning.
+void ANSIGraphical::writeAll(const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(STDOUT_FILENO, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd output = {STDOUT_FILENO, POLLOUT, 0};
+                poll(&output, 1, -1);
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+EventType ANSIGraphical::getEvent() {
+    if (!_isRunning) {
+        return EventType::QUIT;
+    }
+    readInput();
+    if (_inputStart == _inputEnd) {
+        return EventType::NONE;
+    }
+
+    size_t length = 0;
+    EventType event = parseInput(length);
+    if (length > 0) {
+        _inputStart += length;
+        _escapePending = false;
+        return event;
+    }
+    // An escape sequence split across reads: wait for the rest, but not
+    // forever, since a lone ESC is the quit key.
+    auto now = std::chrono::steady_clock::now();
+    if (!_escapePending) {
+        _escapePending = true;
+        _escapeStart = now;
+        return EventType::NONE;
+    }
+    if (now - _escapeStart < ESCAPE_DELAY) {
+        return EventType::NONE;
+    }
+    _escapePending = false;
+    if (_inputEnd - _inputStart == 1) {
+        _inputStart++;
+        return EventType::QUIT;
+    }
+    // The start of a sequence whose end never came.
+    _inputStart = _inputEnd;
+    return EventType::NONE;
+}
+
+// Appends whatever input is waiting behind what is left of the last read.
+void ANSIGraphical::readInput() {
+    if (_inputStart == _inputEnd) {
+        _inputStart = 0;
+        _inputEnd = 0;
+    } else if (_inputStart > 0) {
+        std::memmove(_input, _input + _inputStart, _inputEnd - _inputStart);
+        _inputEnd -= _inputStart;
+        _inputStart = 0;
+    }
+    if (_inputEnd < sizeof(_input)) {
+        ssize_t count = ::read(STDIN_FILENO, _input + _inputEnd, sizeof(_input) - _inputEnd);
+        if (count > 0) {
+            _inputEnd += count;
+        }
+    }
+}
+
+// Decodes the key at _inputStart and sets length to the bytes it took, or
+// to 0 when it is an escape sequence that has not fully arrived yet. CSI
+// sequences are skipped whole (ESC [, parameters, intermediates, final
+// byte), so modified arrows such as ESC[1;5A still read as arrows and
+// other keys leave nothing behind.
+EventType ANSIGraphical::parseInput(size_t &length) {
+    const char *input = _input + _inputStart;
+    size_t left = _inputEnd - _inputStart;
+    char ch = input[0];
+
+    length = 1;
+    if (ch == 27) {
+        if (left < 2) {
+            length = 0;
+            return EventType::NONE;
+        }
+        char code = 0;
+        if (input[1] == '[') {
+            size_t end = 2;
+            while (end < left && input[end] >= 0x20 && input[end] <= 0x3F) {
+                end++;
+            }
+            if (end == left) {
+                length = 0;
+                return EventType::NONE;
+            }
+            length = end + 1;
+            code = input[end];
+        } else if (input[1] == 'O') {
+            if (left < 3) {
+                length = 0;
+                return EventType::NONE;
+            }
+            length = 3;
+            code = input[2];
+        } else {
+            return EventType::QUIT;
+        }
+        switch (code) {
+            case 'A': return EventType::MOVE_UP;
+            case 'B': return EventType::MOVE_DOWN;
+            case 'C': return EventType::MOVE_RIGHT;
+            case 'D': return EventType::MOVE_LEFT;
+            default: return EventType::NONE;
+        }
+    }
+
+    switch (ch) {
+        case 'q': return EventType::QUIT;
+        case '\r':
+        case '\n':
+        case ' ': return EventType::ACTION;
+        case 'p': return EventType::PAUSE;
+        case 'm': return EventType::MENU;
+        case 'n': return EventType::NEXT_LIB;
+        case 'b': return EventType::PREV_LIB;
+        case ']': return EventType::NEXT_GAME;
+        case '[': return EventType::PREV_GAME;
+        case 'z': return EventType::REWIND;
+        default: return EventType::NONE;
+    }
+}
+
+void ANSIGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color) {
+    uint8_t bg = toPalette(color);
+    int left = pos.x / _cellSize;
+    int top = pos.y / _cellSize;
+    int right = (pos.x + width + _cellSize - 1) / _cellSize;
+    int bottom = (pos.y + height + _cellSize - 1) / _cellSize;
+
+    for (int y = top; y < bottom; ++y) {
+        for (int x = left; x < right; ++x) {
+            if (Cell *cell = cellAt(x, y)) {
+                *cell = Cell{' ', cell->fg, bg};
+            }
+        }
+    }
+}
+
+void ANSIGraphical::drawCircle(const Position &pos, int radius, const Color &color) {
+    int cx = pos.x / _cellSize;
+    int cy = pos.y / _cellSize;
+    int r = radius / _cellSize;
+
+    if (r == 0) {
+        // Smaller than a cell: a glyph on top of whatever is underneath.
+        if (Cell *cell = cellAt(cx, cy)) {
+            cell->ch = '.';
+            cell->fg = toPalette(color);
+        }
+        return;
+    }
+    uint8_t bg = toPalette(color);
+    for (int y = -r; y <= r; ++y) {
+        for (int x = -r; x <= r; ++x) {
+            if (x * x + y * y <= r * r) {
+                if (Cell *cell = cellAt(cx + x, cy + y)) {
+                    *cell = Cell{' ', cell->fg, bg};
+                }
+            }
+        }
+    }
+}
+
+void ANSIGraphical::drawSprite(const Sprite &sprite) {
+    if (Cell *cell = cellAt(sprite.position.x / _cellSize, sprite.position.y / _cellSize)) {
+        cell->ch = 'O';
+        cell->fg = DEFAULT_FG;
+    }
+}
+
+void ANSIGraphical::drawText(const Text &text) {
+    // Same pixel-to-column scale as the ncurses backend, so both lay out
+    // the menu identically.
+    int x = text.position.x / 16;
+    int y = text.position.y / 16;
+    uint8_t fg = toPalette(text.color);
+
+    for (char ch : text.content) {
+        if (Cell *cell = cellAt(x++, y)) {
+            cell->ch = (ch >= 32 && ch < 127) ? ch : '?';
+            cell->fg = fg;
+        }
+    }
+}
+
+void ANSIGraphical::drawCell(int x, int y, const Color &color) {
+    if (Cell *cell = cellAt(x, y)) {
+        *cell = Cell{' ', cell->fg, toPalette(color)};
+    }
+}
+
+void ANSIGraphical::setCellSize(int size) {
+    _cellSize = size > 0 ? size : 1;
+}
+
+std::string ANSIGraphical::getName() const {
+    return "ANSI";
+}
+
+extern "C" {
+    arcade::IGraphical* create() {
+        return new arcade::ANSIGraphical();
+    }
+
+    void destroy(arcade::IGraphical* obj) {
+        delete obj;
+    }
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef ANSI_HPP_
+#define ANSI_HPP_
+
+#include "../../../src/interfaces/IGraphical.hpp"
+#include <termios.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace arcade {
+
+class ANSIGraphical : public IGraphical {
+public:
+    ANSIGraphical();
+    ~ANSIGraphical() override;
+
+    void init(int width, int height, const std::string &title) override;
+    void close() override;
+    bool isOpen() const override;
+    void clear() override;
+    void display() override;
+
+    EventType getEvent() override;
+
+    void drawRectangle(const Position &pos, int width, int height, const Color &color) override;
+    void drawCircle(const Position &pos, int radius, const Color &color) override;
+    void drawSprite(const Sprite &sprite) override;
+    void drawText(const Text &text) override;
+
+    void drawCell(int x, int y, const Color &color) override;
+    void setCellSize(int size) override;
+
+    std::string getName() const override;
+
+    // Bytes emitted to the terminal by the last display() call.
+    size_t getLastFrameBytes() const;
+
+private:
+    struct Cell {
+        char ch;
+        uint8_t fg;
+        uint8_t bg;
+
+        bool operator==(const Cell &other) const {
+            return ch == other.ch && fg == other.fg && bg == other.bg;
+        }
+        bool operator!=(const Cell &other) const { return !(*this == other); }
+    };
+
+    // Same 32x32x32 quantisation as the ncurses backend, resolved to the
+    // xterm 256-colour palette once in the constructor.
+    static constexpr int LUT_BITS = 5;
+    static constexpr int LUT_LEVELS = 1 << LUT_BITS;
+    // Worst case for one cell: cursor move, fg+bg SGR and the glyph.
+    static constexpr size_t MAX_BYTES_PER_CELL = 32;
+    static constexpr uint8_t DEFAULT_FG = 7;
+    static constexpr uint8_t DEFAULT_BG = 0;
+    // How long the rest of an escape sequence may take to arrive before a
+    // lone ESC counts as the quit key.
+    static constexpr std::chrono::milliseconds ESCAPE_DELAY{50};
+
+    bool _isRunning;
+    int _columns;
+    int _rows;
+    int _cellSize;
+    bool _fullRedraw;
+    struct termios _savedTermios;
+    std::vector<Cell> _front;
+    std::vector<Cell> _back;
+    std::vector<char> _output;
+    std::vector<uint8_t> _paletteLut;
+    char _input[64];
+    size_t _inputStart;
+    size_t _inputEnd;
+    bool _escapePending;
+    std::chrono::steady_clock::time_point _escapeStart;
+    size_t _lastFrameBytes;
+    size_t _totalFrameBytes;
+    size_t _peakFrameBytes;
+    size_t _frameCount;
+
+    void resize();
+    void writeAll(const char *data, size_t size);
+    void readInput();
+    uint8_t toPalette(const Color &color) const {
+        return _paletteLut[((color.r >> (8 - LUT_BITS)) << (2 * LUT_BITS))
+                         | ((color.g >> (8 - LUT_BITS)) << LUT_BITS)
+                         | (color.b >> (8 - LUT_BITS))];
+    }
+    Cell *cellAt(int x, int y) {
+        if (x < 0 || y < 0 || x >= _columns || y >= _rows) {
+            return nullptr;
+        }
+        return &_back[y * _columns + x];
+    }
+    EventType parseInput(size_t &length);
+};
+
+extern "C" {
+    arcade::IGraphical* create();
+    void destroy(arcade::IGraphical* obj);
+}
+
+} // namespace arcade
+
+#endif // ANSI_HPP_
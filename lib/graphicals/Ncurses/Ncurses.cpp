@@ -1,15 +1,69 @@
 #include "Ncurses.hpp"
 #include <ncurses.h>
 #include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cerrno>
+#include <cstring>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace arcade {
 
+namespace {
+
+volatile sig_atomic_t g_resizePending = 0;
+struct sigaction g_previousWinch;
+
+void onWinch(int sig) {
+    g_resizePending = 1;
+    if (g_previousWinch.sa_handler != SIG_DFL && g_previousWinch.sa_handler != SIG_IGN) {
+        g_previousWinch.sa_handler(sig);
+    }
+}
+
+void writeAll(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+void closeFd(int &fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+}
+
 NcursesGraphical::NcursesGraphical() : 
     _mainWindow(nullptr), 
     _isRunning(false), 
     _width(0), 
     _height(0),
-    _cellSize(20) {}
+    _cellSize(20),
+    _screen(nullptr),
+    _screenOutput(nullptr),
+    _screenFd(-1),
+    _terminalFd(-1),
+    _captureFd(-1),
+    _totalFrameBytes(0),
+    _lastFrameBytes(0),
+    _peakFrameBytes(0),
+    _frameCount(0),
+    _colorMode(ColorMode::MONOCHROME),
+    _nextPair(1),
+    _nextColor(BASE_COLORS) {}
 
 NcursesGraphical::~NcursesGraphical() {
     if (_isRunning) {
@@ -19,10 +73,9 @@ NcursesGraphical::~NcursesGraphical() {
 
 void NcursesGraphical::init(int width, int height, const std::string &title) {
     (void)title;
-    initscr();
-    if (!stdscr) {
-        throw std::runtime_error("Failed to initialize NCurses");
-    }
+    (void)width;
+    (void)height;
+    openScreen();
     start_color();
     cbreak();
     noecho();
@@ -30,17 +83,28 @@ void NcursesGraphical::init(int width, int height, const std::string &title) {
     timeout(16);
     keypad(stdscr, TRUE);
     curs_set(0);
-    _width = width;
-    _height = height;
+    getmaxyx(stdscr, _height, _width);
     _mainWindow = newwin(_height, _width, 0, 0);
     if (!_mainWindow) {
         endwin();
+        closeScreen();
         throw std::runtime_error("Failed to create NCurses window");
     }
     keypad(_mainWindow, TRUE);
+    nodelay(_mainWindow, TRUE);
     initColors();
-    clear();
-    refresh();
+
+    struct sigaction action = {};
+    action.sa_handler = onWinch;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    g_resizePending = 0;
+    sigaction(SIGWINCH, &action, &g_previousWinch);
+
+    _totalFrameBytes = 0;
+    _lastFrameBytes = 0;
+    _peakFrameBytes = 0;
+    _frameCount = 0;
     _isRunning = true;
 }
 
@@ -48,16 +112,85 @@ void NcursesGraphical::close() {
     if (!_isRunning) return;
     
     _isRunning = false;
+    sigaction(SIGWINCH, &g_previousWinch, nullptr);
     
     if (_mainWindow) {
         werase(_mainWindow);
-        wrefresh(_mainWindow);
+        wnoutrefresh(_mainWindow);
+        doupdate();
         delwin(_mainWindow);
         _mainWindow = nullptr;
     }
-    clear();
-    refresh();
     endwin();
+    bool counted = _captureFd >= 0;
+    closeScreen();
+    if (_frameCount > 0 && counted) {
+        std::cerr << "NCurses: " << _frameCount << " frames, "
+                  << (_totalFrameBytes / _frameCount) << " bytes/frame average, "
+                  << _peakFrameBytes << " bytes peak" << std::endl;
+    } else if (_frameCount > 0) {
+        std::cerr << "NCurses: " << _frameCount << " frames, bytes not counted" << std::endl;
+    }
+}
+
+// The screen writes to a duplicate of stdout of its own, so its output can
+// be told apart from anything else the process prints. ncurses writes
+// straight to that descriptor (not through the FILE), which is what lets
+// display() point it at the capture buffer for the length of a frame.
+void NcursesGraphical::openScreen() {
+    _terminalFd = dup(STDOUT_FILENO);
+    _screenFd = dup(STDOUT_FILENO);
+    _screenOutput = _screenFd >= 0 ? fdopen(_screenFd, "w") : nullptr;
+    if (_terminalFd < 0 || !_screenOutput) {
+        closeScreen();
+        throw std::runtime_error("Failed to open the terminal for NCurses");
+    }
+    _screen = newterm(nullptr, _screenOutput, stdin);
+    if (!_screen) {
+        closeScreen();
+        throw std::runtime_error("Failed to initialize NCurses");
+    }
+    set_term(_screen);
+    _captureFd = memfd_create("arcade-ncurses-frame", MFD_CLOEXEC);
+}
+
+void NcursesGraphical::closeScreen() {
+    if (_screen) {
+        delscreen(_screen);
+        _screen = nullptr;
+    }
+    if (_screenOutput) {
+        fclose(_screenOutput);
+        _screenOutput = nullptr;
+        _screenFd = -1;
+    }
+    closeFd(_screenFd);
+    closeFd(_terminalFd);
+    closeFd(_captureFd);
+}
+
+// Runs doupdate() with the screen's descriptor pointing at the capture
+// buffer, then passes the frame on to the terminal in one write. What was
+// captured is exactly what this backend sent, whatever other threads print.
+size_t NcursesGraphical::updateCounted() {
+    if (_captureFd < 0 || dup2(_captureFd, _screenFd) < 0) {
+        doupdate();
+        return 0;
+    }
+    doupdate();
+    dup2(_terminalFd, _screenFd);
+    off_t size = lseek(_captureFd, 0, SEEK_CUR);
+    if (size <= 0) {
+        return 0;
+    }
+    _frame.resize(static_cast<size_t>(size));
+    ssize_t got = pread(_captureFd, _frame.data(), _frame.size(), 0);
+    lseek(_captureFd, 0, SEEK_SET);
+    if (got <= 0) {
+        return 0;
+    }
+    writeAll(_terminalFd, _frame.data(), static_cast<size_t>(got));
+    return static_cast<size_t>(got);
 }
 
 bool NcursesGraphical::isOpen() const {
@@ -65,17 +198,39 @@ bool NcursesGraphical::isOpen() const {
 }
 
 void NcursesGraphical::clear() {
-    wclear(_mainWindow);
-    werase(stdscr);
-    refresh();
+    if (!_mainWindow) return;
+
+    if (g_resizePending) {
+        handleResize();
+    }
+    werase(_mainWindow);
 }
 
 void NcursesGraphical::display() {
+    if (!_mainWindow) return;
+
     box(_mainWindow, 0, 0);
-    wrefresh(_mainWindow);
-    refresh();
-    napms(16);
-    flushinp();
+    wnoutrefresh(_mainWindow);
+    _lastFrameBytes = updateCounted();
+    _totalFrameBytes += _lastFrameBytes;
+    _peakFrameBytes = std::max(_peakFrameBytes, _lastFrameBytes);
+    _frameCount++;
+}
+
+size_t NcursesGraphical::getLastFrameBytes() const {
+    return _lastFrameBytes;
+}
+
+void NcursesGraphical::handleResize() {
+    struct winsize size;
+
+    g_resizePending = 0;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        resizeterm(size.ws_row, size.ws_col);
+    }
+    getmaxyx(stdscr, _height, _width);
+    wresize(_mainWindow, _height, _width);
+    clearok(curscr, TRUE);
 }
 
 EventType NcursesGraphical::getEvent() {
@@ -87,6 +242,10 @@ EventType NcursesGraphical::getEvent() {
     if (ch == ERR) {
         return EventType::NONE;
     }
+    if (ch == KEY_RESIZE) {
+        handleResize();
+        return EventType::NONE;
+    }
 
     switch (ch) {
         case 27:
@@ -104,13 +263,14 @@ EventType NcursesGraphical::getEvent() {
         case 'b': return EventType::PREV_LIB;
         case ']': return EventType::NEXT_GAME;
         case '[': return EventType::PREV_GAME;
+        case 'z': return EventType::REWIND;
         default: return EventType::NONE;
     }
 }
 
 void NcursesGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color) {
     short colorPair = getColorPair(color);
-    wattron(_mainWindow, COLOR_PAIR(colorPair));
+    wattron(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
     
     for (int y = 0; y < height; ++y) {
         for (int x = 0; x < width; ++x) {
@@ -118,12 +278,12 @@ void NcursesGraphical::drawRectangle(const Position &pos, int width, int height,
         }
     }
     
-    wattroff(_mainWindow, COLOR_PAIR(colorPair));
+    wattroff(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
 }
 
 void NcursesGraphical::drawCircle(const Position &pos, int radius, const Color &color) {
     short colorPair = getColorPair(color);
-    wattron(_mainWindow, COLOR_PAIR(colorPair));
+    wattron(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
     
     for (int y = -radius; y <= radius; ++y) {
         for (int x = -radius; x <= radius; ++x) {
@@ -133,7 +293,7 @@ void NcursesGraphical::drawCircle(const Position &pos, int radius, const Color &
         }
     }
     
-    wattroff(_mainWindow, COLOR_PAIR(colorPair));
+    wattroff(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
 }
 
 void NcursesGraphical::drawSprite(const Sprite &sprite) {
@@ -145,7 +305,6 @@ void NcursesGraphical::drawText(const Text &text) {
     wattron(_mainWindow, COLOR_PAIR(colorPair));
     mvwprintw(_mainWindow, text.position.y / 16, text.position.x / 16, "%s", text.content.c_str());
     wattroff(_mainWindow, COLOR_PAIR(colorPair));
-    wrefresh(_mainWindow);
 }
 
 void NcursesGraphical::drawCell(int x, int y, const Color &color) {
@@ -155,7 +314,6 @@ void NcursesGraphical::drawCell(int x, int y, const Color &color) {
     wattron(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
     mvwaddch(_mainWindow, y, x, ' ');
     wattroff(_mainWindow, COLOR_PAIR(colorPair) | A_REVERSE);
-    wrefresh(_mainWindow);
 }
 
 void NcursesGraphical::setCellSize(int size) {
@@ -167,26 +325,121 @@ std::string NcursesGraphical::getName() const {
 }
 
 void NcursesGraphical::initColors() {
-    if (has_colors()) {
-        init_pair(1, COLOR_RED, COLOR_RED);
-        init_pair(2, COLOR_GREEN, COLOR_GREEN);
-        init_pair(3, COLOR_YELLOW, COLOR_YELLOW);
-        init_pair(4, COLOR_BLUE, COLOR_BLUE);
-        init_pair(5, COLOR_MAGENTA, COLOR_MAGENTA);
-        init_pair(6, COLOR_CYAN, COLOR_CYAN);
-        init_pair(7, COLOR_WHITE, COLOR_WHITE);
-    }
-}
-
-short NcursesGraphical::getColorPair(const Color& color) {
-    if (color.r > 127 && color.g < 127 && color.b < 127) return 1;
-    if (color.r < 127 && color.g > 127 && color.b < 127) return 2;
-    if (color.r > 127 && color.g > 127 && color.b < 127) return 3;
-    if (color.r < 127 && color.g < 127 && color.b > 127) return 4;
-    if (color.r > 127 && color.g < 127 && color.b > 127) return 5;
-    if (color.r < 127 && color.g > 127 && color.b > 127) return 6;
-    if (color.r > 127 && color.g > 127 && color.b > 127) return 7;
-    return 0;
+    _colorLut.assign(LUT_SIZE, -1);
+    _pairLut.assign(LUT_SIZE, -1);
+    _pairByColor.clear();
+    _nextPair = 1;
+    _nextColor = BASE_COLORS;
+    _colorMode = ColorMode::MONOCHROME;
+    if (!has_colors()) {
+        std::fill(_pairLut.begin(), _pairLut.end(), 0);
+        return;
+    }
+
+    const char *colorTerm = std::getenv("COLORTERM");
+    bool truecolor = colorTerm && (std::strcmp(colorTerm, "truecolor") == 0 || std::strcmp(colorTerm, "24bit") == 0);
+    if (COLORS >= 256 && truecolor && can_change_color()) {
+        _colorMode = ColorMode::TRUECOLOR;
+    } else if (COLORS >= 256) {
+        _colorMode = ColorMode::PALETTE_256;
+    } else {
+        _colorMode = ColorMode::BASIC;
+    }
+    _pairByColor.assign(_colorMode == ColorMode::BASIC ? BASE_COLORS : 256, -1);
+
+    // Truecolor entries stay at -1 and get a redefined palette slot on first
+    // use; the other modes resolve every cube cell to a fixed colour now.
+    for (int r = 0; r < LUT_LEVELS; ++r) {
+        for (int g = 0; g < LUT_LEVELS; ++g) {
+            for (int b = 0; b < LUT_LEVELS; ++b) {
+                int index = (r * LUT_LEVELS + g) * LUT_LEVELS + b;
+                int cr = r * 255 / (LUT_LEVELS - 1);
+                int cg = g * 255 / (LUT_LEVELS - 1);
+                int cb = b * 255 / (LUT_LEVELS - 1);
+                if (_colorMode == ColorMode::PALETTE_256) {
+                    _colorLut[index] = nearestPaletteColor(cr, cg, cb);
+                } else if (_colorMode == ColorMode::BASIC) {
+                    _colorLut[index] = nearestBasicColor(cr, cg, cb);
+                }
+            }
+        }
+    }
+}
+
+short NcursesGraphical::nearestBasicColor(int r, int g, int b) {
+    int max = std::max(r, std::max(g, b));
+    if (max < 48) {
+        return COLOR_BLACK;
+    }
+    // Threshold against the brightest channel so greys become white and
+    // tinted colours keep their hue instead of collapsing to black.
+    int half = max / 2;
+    return (r > half ? COLOR_RED : 0) | (g > half ? COLOR_GREEN : 0) | (b > half ? COLOR_BLUE : 0);
+}
+
+short NcursesGraphical::nearestPaletteColor(int r, int g, int b) {
+    static const int levels[6] = {0, 95, 135, 175, 215, 255};
+    auto nearestLevel = [](int value) {
+        int best = 0;
+        for (int i = 1; i < 6; ++i) {
+            if (std::abs(levels[i] - value) < std::abs(levels[best] - value)) {
+                best = i;
+            }
+        }
+        return best;
+    };
+    auto distance = [r, g, b](int cr, int cg, int cb) {
+        return (r - cr) * (r - cr) + (g - cg) * (g - cg) + (b - cb) * (b - cb);
+    };
+
+    int ri = nearestLevel(r);
+    int gi = nearestLevel(g);
+    int bi = nearestLevel(b);
+    int cubeDistance = distance(levels[ri], levels[gi], levels[bi]);
+
+    int grayIndex = std::max(0, std::min(23, ((r + g + b) / 3 - 8 + 5) / 10));
+    int gray = 8 + grayIndex * 10;
+    if (distance(gray, gray, gray) < cubeDistance) {
+        return 232 + grayIndex;
+    }
+    return 16 + ri * 36 + gi * 6 + bi;
+}
+
+short NcursesGraphical::allocatePair(int index) {
+    short colorNumber = _colorLut[index];
+
+    if (colorNumber < 0) {
+        int maxColors = std::min(COLORS, 256);
+        if (_nextColor >= maxColors) {
+            int r = index / (LUT_LEVELS * LUT_LEVELS);
+            int g = (index / LUT_LEVELS) % LUT_LEVELS;
+            int b = index % LUT_LEVELS;
+            colorNumber = nearestPaletteColor(r * 255 / (LUT_LEVELS - 1), g * 255 / (LUT_LEVELS - 1),
+                                              b * 255 / (LUT_LEVELS - 1));
+        } else {
+            colorNumber = _nextColor++;
+            int r = index / (LUT_LEVELS * LUT_LEVELS);
+            int g = (index / LUT_LEVELS) % LUT_LEVELS;
+            int b = index % LUT_LEVELS;
+            init_color(colorNumber, r * 1000 / (LUT_LEVELS - 1), g * 1000 / (LUT_LEVELS - 1),
+                       b * 1000 / (LUT_LEVELS - 1));
+        }
+        _colorLut[index] = colorNumber;
+    }
+
+    short pair = _pairByColor[colorNumber];
+    if (pair < 0) {
+        // Narrow ncurses keeps the pair in 8 attribute bits.
+        int maxPairs = std::min(COLOR_PAIRS, 256);
+        if (_nextPair >= maxPairs) {
+            return 0;
+        }
+        pair = _nextPair++;
+        init_pair(pair, colorNumber, COLOR_BLACK);
+        _pairByColor[colorNumber] = pair;
+    }
+    _pairLut[index] = pair;
+    return pair;
 }
 
 extern "C" {
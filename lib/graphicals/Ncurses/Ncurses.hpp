@@ -3,8 +3,10 @@
 
 #include "../../../src/interfaces/IGraphical.hpp"
 #include <ncurses.h>
+#include <cstdio>
 #include <string>
 #include <map>
+#include <vector>
 #include <iostream>
 
 namespace arcade {
@@ -32,15 +34,65 @@ public:
     
     std::string getName() const override;
 
+    // Bytes emitted to the terminal by the last display() call.
+    size_t getLastFrameBytes() const;
+
 private:
     WINDOW* _mainWindow;
     bool _isRunning;
     int _width;
     int _height;
     int _cellSize;
+    SCREEN *_screen;
+    FILE *_screenOutput;
+    // The screen's own descriptor, the terminal it normally points to, and
+    // the in-memory file each frame is captured into to be counted.
+    int _screenFd;
+    int _terminalFd;
+    int _captureFd;
+    std::vector<char> _frame;
+    size_t _totalFrameBytes;
+    size_t _lastFrameBytes;
+    size_t _peakFrameBytes;
+    size_t _frameCount;
+
+    enum class ColorMode {
+        MONOCHROME,
+        BASIC,
+        PALETTE_256,
+        TRUECOLOR
+    };
+
+    // RGB is quantised to a LUT_LEVELS^3 cube; each cell resolves to a
+    // colour pair once, so a lookup on the draw path is one table read.
+    static constexpr int LUT_BITS = 5;
+    static constexpr int LUT_LEVELS = 1 << LUT_BITS;
+    static constexpr int LUT_SIZE = LUT_LEVELS * LUT_LEVELS * LUT_LEVELS;
+    static constexpr short BASE_COLORS = 16;
 
+    ColorMode _colorMode;
+    std::vector<short> _colorLut;
+    std::vector<short> _pairLut;
+    std::vector<short> _pairByColor;
+    short _nextPair;
+    short _nextColor;
+
+    void openScreen();
+    void closeScreen();
+    size_t updateCounted();
     void initColors();
-    short getColorPair(const Color& color);
+    void handleResize();
+    short allocatePair(int index);
+    static short nearestBasicColor(int r, int g, int b);
+    static short nearestPaletteColor(int r, int g, int b);
+
+    short getColorPair(const Color& color) {
+        int index = ((color.r >> (8 - LUT_BITS)) << (2 * LUT_BITS))
+                  | ((color.g >> (8 - LUT_BITS)) << LUT_BITS)
+                  | (color.b >> (8 - LUT_BITS));
+        short pair = _pairLut[index];
+        return pair >= 0 ? pair : allocatePair(index);
+    }
 };
 
 extern "C" {
@@ -0,0 +1,190 @@
+#include "Null.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace arcade {
+
+namespace {
+
+void add(NullGraphical::FrameCounts &into, const NullGraphical::FrameCounts &from) {
+    into.clear += from.clear;
+    into.display += from.display;
+    into.cell += from.cell;
+    into.rectangle += from.rectangle;
+    into.circle += from.circle;
+    into.sprite += from.sprite;
+    into.text += from.text;
+}
+
+}
+
+NullGraphical::NullGraphical() :
+    _isRunning(false),
+    _tickLimit(0),
+    _ticks(0),
+    _scriptIndex(0),
+    _record(nullptr) {}
+
+NullGraphical::~NullGraphical() {
+    if (_isRunning) {
+        close();
+    }
+}
+
+void NullGraphical::init(int width, int height, const std::string &title) {
+    (void)title;
+    _current = FrameCounts();
+    _lastFrame = FrameCounts();
+    _totals = FrameCounts();
+    _tickLimit = 0;
+    _ticks = 0;
+    _script.clear();
+    _scriptIndex = 0;
+
+    if (const char *ticks = std::getenv("ARCADE_NULL_TICKS")) {
+        _tickLimit = std::strtoul(ticks, nullptr, 10);
+    }
+    if (const char *script = std::getenv("ARCADE_NULL_EVENTS")) {
+        _script = parseEventScript(script);
+    }
+    if (const char *path = std::getenv("ARCADE_NULL_RECORD")) {
+        _record = std::fopen(path, "wb");
+        if (!_record) {
+            throw std::runtime_error("Cannot open draw log: " + std::string(path));
+        }
+        _writer = DrawLogWriter();
+        _writer.init(width, height);
+    }
+    _isRunning = true;
+}
+
+void NullGraphical::close() {
+    if (!_isRunning) return;
+
+    _isRunning = false;
+    if (_record) {
+        flushRecord();
+        std::fclose(_record);
+        _record = nullptr;
+    }
+    size_t frames = _totals.display;
+    if (frames > 0) {
+        std::cerr << "Null: " << frames << " frames, per frame: "
+                  << static_cast<double>(_totals.cell) / frames << " cells, "
+                  << static_cast<double>(_totals.rectangle) / frames << " rectangles, "
+                  << static_cast<double>(_totals.circle) / frames << " circles, "
+                  << static_cast<double>(_totals.sprite) / frames << " sprites, "
+                  << static_cast<double>(_totals.text) / frames << " texts, "
+                  << static_cast<double>(_totals.clear) / frames << " clears" << std::endl;
+    }
+}
+
+bool NullGraphical::isOpen() const {
+    return _isRunning;
+}
+
+void NullGraphical::flushRecord() {
+    const std::vector<uint8_t> &data = _writer.data();
+    if (!data.empty()) {
+        std::fwrite(data.data(), 1, data.size(), _record);
+        _writer.drain();
+    }
+}
+
+void NullGraphical::clear() {
+    _current.clear++;
+    if (_record) {
+        _writer.clear();
+    }
+}
+
+void NullGraphical::display() {
+    _current.display++;
+    if (_record) {
+        _writer.display();
+        flushRecord();
+    }
+    add(_totals, _current);
+    _lastFrame = _current;
+    _current = FrameCounts();
+}
+
+EventType NullGraphical::getEvent() {
+    if (!_isRunning) {
+        return EventType::QUIT;
+    }
+    _ticks++;
+    if (_tickLimit > 0 && _ticks > _tickLimit) {
+        return EventType::QUIT;
+    }
+    if (_scriptIndex < _script.size() && _script[_scriptIndex].first <= _ticks) {
+        return _script[_scriptIndex++].second;
+    }
+    return EventType::NONE;
+}
+
+void NullGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color) {
+    _current.rectangle++;
+    if (_record) {
+        _writer.rectangle(pos, width, height, color);
+    }
+}
+
+void NullGraphical::drawCircle(const Position &pos, int radius, const Color &color) {
+    _current.circle++;
+    if (_record) {
+        _writer.circle(pos, radius, color);
+    }
+}
+
+void NullGraphical::drawSprite(const Sprite &sprite) {
+    _current.sprite++;
+    if (_record) {
+        _writer.sprite(sprite);
+    }
+}
+
+void NullGraphical::drawText(const Text &text) {
+    _current.text++;
+    if (_record) {
+        _writer.text(text);
+    }
+}
+
+void NullGraphical::drawCell(int x, int y, const Color &color) {
+    _current.cell++;
+    if (_record) {
+        _writer.cell(x, y, color);
+    }
+}
+
+void NullGraphical::setCellSize(int size) {
+    if (_record) {
+        _writer.cellSize(size);
+    }
+}
+
+std::string NullGraphical::getName() const {
+    return "Null";
+}
+
+const NullGraphical::FrameCounts &NullGraphical::getLastFrame() const {
+    return _lastFrame;
+}
+
+const NullGraphical::FrameCounts &NullGraphical::getTotals() const {
+    return _totals;
+}
+
+extern "C" {
+    arcade::IGraphical* create() {
+        return new arcade::NullGraphical();
+    }
+
+    void destroy(arcade::IGraphical* obj) {
+        delete obj;
+    }
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef NULL_HPP_
+#define NULL_HPP_
+
+#include "../../../src/interfaces/IGraphical.hpp"
+#include "../../../src/interfaces/DrawLog.hpp"
+#include "../../../src/interfaces/EventScript.hpp"
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arcade {
+
+// Backend that draws nothing. It counts every call per frame and can
+// record them into a DrawLog, for profiling games and Core without a
+// display. Configured through:
+//   ARCADE_NULL_RECORD  path of the draw log to write
+//   ARCADE_NULL_TICKS   report QUIT after this many getEvent() calls
+//   ARCADE_NULL_EVENTS  input returned at given getEvent() calls,
+//                       e.g. "1:ACTION,60:MOVE_UP"
+// Ticks count polls rather than frames because Core also polls in loops
+// that draw nothing, such as the game-over screen.
+class NullGraphical : public IGraphical {
+public:
+    struct FrameCounts {
+        size_t clear = 0;
+        size_t display = 0;
+        size_t cell = 0;
+        size_t rectangle = 0;
+        size_t circle = 0;
+        size_t sprite = 0;
+        size_t text = 0;
+    };
+
+    NullGraphical();
+    ~NullGraphical() override;
+
+    void init(int width, int height, const std::string &title) override;
+    void close() override;
+    bool isOpen() const override;
+    void clear() override;
+    void display() override;
+
+    EventType getEvent() override;
+
+    void drawRectangle(const Position &pos, int width, int height, const Color &color) override;
+    void drawCircle(const Position &pos, int radius, const Color &color) override;
+    void drawSprite(const Sprite &sprite) override;
+    void drawText(const Text &text) override;
+
+    void drawCell(int x, int y, const Color &color) override;
+    void setCellSize(int size) override;
+
+    std::string getName() const override;
+
+    // Calls made during the last completed frame, and since init().
+    const FrameCounts &getLastFrame() const;
+    const FrameCounts &getTotals() const;
+
+private:
+    bool _isRunning;
+    size_t _tickLimit;
+    size_t _ticks;
+    FrameCounts _current;
+    FrameCounts _lastFrame;
+    FrameCounts _totals;
+    EventScript _script;
+    size_t _scriptIndex;
+    FILE *_record;
+    DrawLogWriter _writer;
+
+    void flushRecord();
+};
+
+extern "C" {
+    arcade::IGraphical* create();
+    void destroy(arcade::IGraphical* obj);
+}
+
+} // namespace arcade
+
+#endif // NULL_HPP_
@@ -1,6 +1,9 @@
 #include "SDL2.hpp"
 #include <stdexcept>
 #include <iostream>
+#include <future>
+#include <cstdlib>
+#include <algorithm>
 
 namespace arcade {
 
@@ -11,7 +14,17 @@ SDL2Graphical::SDL2Graphical() :
     _isRunning(false),
     _width(0),
     _height(0),
-    _cellSize(20) {}
+    _cellSize(20),
+    _recordFile(nullptr),
+    _recordY4M(true),
+    _recordWidth(0),
+    _recordHeight(0),
+    _recordStopping(false),
+    _capturedFrames(0),
+    _writtenFrames(0),
+    _droppedFrames(0),
+    _captureSeconds(0.0),
+    _capturePeakSeconds(0.0) {}
 
 SDL2Graphical::~SDL2Graphical() {
     if (_isRunning) {
@@ -20,12 +33,13 @@ SDL2Graphical::~SDL2Graphical() {
 }
 
 void SDL2Graphical::init(int width, int height, const std::string &title) {
+    // SDL_ttf does not depend on the video subsystem: open the font on a
+    // worker while the window and renderer are created.
+    std::future<TTF_Font*> font = std::async(std::launch::async, &SDL2Graphical::loadFont);
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         throw std::runtime_error("SDL could not initialize!");
     }
-    if (TTF_Init() < 0) {
-        throw std::runtime_error("SDL_ttf could not initialize!");
-    }
 
     _window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED,
         SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN);
@@ -37,17 +51,31 @@ void SDL2Graphical::init(int width, int height, const std::string &title) {
     if (!_renderer) {
         throw std::runtime_error("Renderer could not be created!");
     }
-    _font = TTF_OpenFont("assets/fonts/DejaVuSans.ttf", 24);
-    if (!_font) {
+    _font = font.get();
+    _width = width;
+    _height = height;
+    _isRunning = true;
+
+    const char* record = std::getenv("ARCADE_SDL2_RECORD");
+    if (record && *record) {
+        _recordPath = record;
+        startRecording();
+    }
+}
+
+TTF_Font* SDL2Graphical::loadFont() {
+    if (TTF_Init() < 0) {
+        throw std::runtime_error("SDL_ttf could not initialize!");
+    }
+    TTF_Font* font = TTF_OpenFont("assets/fonts/DejaVuSans.ttf", 24);
+    if (!font) {
         std::cerr << "Warning: Failed to load font from assets/fonts/DejaVuSans.ttf" << std::endl;
-        _font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", 24);
-        if (!_font) {
+        font = TTF_OpenFont("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf", 24);
+        if (!font) {
             throw std::runtime_error("Failed to load font!");
         }
     }
-    _width = width;
-    _height = height;
-    _isRunning = true;
+    return font;
 }
 
 void SDL2Graphical::close() {
@@ -55,6 +83,7 @@ void SDL2Graphical::close() {
     return;
     
     _isRunning = false;    
+    stopRecording();
     if (_font) {
         TTF_CloseFont(_font);
         _font = nullptr;
@@ -81,6 +110,9 @@ void SDL2Graphical::clear() {
 }
 
 void SDL2Graphical::display() {
+    if (_recordFile) {
+        captureFrame();
+    }
     SDL_RenderPresent(_renderer);
     SDL_Delay(1000/60);
 }
@@ -106,6 +138,7 @@ EventType SDL2Graphical::getEvent() {
                     case SDLK_b: return EventType::PREV_LIB;
                     case SDLK_RIGHTBRACKET: return EventType::NEXT_GAME;
                     case SDLK_LEFTBRACKET: return EventType::PREV_GAME;
+                    case SDLK_z: return EventType::REWIND;
                     case SDLK_ESCAPE: return EventType::QUIT;
                 }
         }
@@ -224,6 +257,170 @@ void SDL2Graphical::drawAnimatedText(const Text& text) {
     }
 }
 
+void SDL2Graphical::startRecording() {
+    if (SDL_GetRendererOutputSize(_renderer, &_recordWidth, &_recordHeight) < 0) {
+        _recordWidth = _width;
+        _recordHeight = _height;
+    }
+    _recordFile = std::fopen(_recordPath.c_str(), "wb");
+    if (!_recordFile) {
+        std::cerr << "Warning: Cannot open recording file " << _recordPath << std::endl;
+        return;
+    }
+    std::setvbuf(_recordFile, nullptr, _IOFBF, 1 << 20);
+
+    _recordY4M = _recordPath.size() < 4 || _recordPath.compare(_recordPath.size() - 4, 4, ".yuv") != 0;
+    if (_recordY4M) {
+        std::fprintf(_recordFile, "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 C420jpeg\n", _recordWidth, _recordHeight);
+    }
+
+    _recordBuffers.assign(RECORD_POOL_SIZE, std::vector<uint32_t>(static_cast<size_t>(_recordWidth) * _recordHeight));
+    _freeBuffers.clear();
+    for (size_t i = 0; i < RECORD_POOL_SIZE; i++) {
+        _freeBuffers.push_back(i);
+    }
+    _pendingFrames.clear();
+    _recordStopping = false;
+    _capturedFrames = 0;
+    _writtenFrames = 0;
+    _droppedFrames = 0;
+    _captureSeconds = 0.0;
+    _capturePeakSeconds = 0.0;
+    _recordWriter = std::thread(&SDL2Graphical::recordLoop, this);
+}
+
+void SDL2Graphical::stopRecording() {
+    if (!_recordFile) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_recordMutex);
+        _recordStopping = true;
+    }
+    _recordReady.notify_one();
+    _recordWriter.join();
+    std::fclose(_recordFile);
+    _recordFile = nullptr;
+    _recordBuffers.clear();
+
+    size_t frames = _capturedFrames + _droppedFrames;
+    std::cerr << "SDL2 recording: " << _writtenFrames << " frames written to " << _recordPath
+              << ", " << _droppedFrames << " dropped";
+    if (frames > 0) {
+        std::cerr << ", " << (_captureSeconds / frames * 1e6) << " us/frame readback average, "
+                  << (_capturePeakSeconds * 1e6) << " us peak";
+    }
+    std::cerr << std::endl;
+}
+
+void SDL2Graphical::captureFrame() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(_recordMutex);
+        if (_freeBuffers.empty()) {
+            index = RECORD_POOL_SIZE;
+        } else {
+            index = _freeBuffers.back();
+            _freeBuffers.pop_back();
+        }
+    }
+    if (index == RECORD_POOL_SIZE) {
+        _droppedFrames++;
+    } else {
+        std::vector<uint32_t>& pixels = _recordBuffers[index];
+        if (SDL_RenderReadPixels(_renderer, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                                 pixels.data(), _recordWidth * 4) < 0) {
+            std::lock_guard<std::mutex> lock(_recordMutex);
+            _freeBuffers.push_back(index);
+            _droppedFrames++;
+        } else {
+            {
+                std::lock_guard<std::mutex> lock(_recordMutex);
+                _pendingFrames.push_back(index);
+            }
+            _recordReady.notify_one();
+            _capturedFrames++;
+        }
+    }
+    double elapsed = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    _captureSeconds += elapsed;
+    if (elapsed > _capturePeakSeconds) {
+        _capturePeakSeconds = elapsed;
+    }
+}
+
+void SDL2Graphical::recordLoop() {
+    std::vector<uint8_t> yuv;
+    std::unique_lock<std::mutex> lock(_recordMutex);
+    while (true) {
+        _recordReady.wait(lock, [this] { return _recordStopping || !_pendingFrames.empty(); });
+        if (_pendingFrames.empty()) {
+            break;
+        }
+        size_t index = _pendingFrames.front();
+        _pendingFrames.pop_front();
+        lock.unlock();
+        writeFrame(_recordBuffers[index], yuv);
+        lock.lock();
+        _freeBuffers.push_back(index);
+        _writtenFrames++;
+    }
+}
+
+// BT.601 studio-swing I420: full-resolution luma, chroma from the average of
+// each 2x2 block (centred siting, as announced by C420jpeg).
+void SDL2Graphical::writeFrame(const std::vector<uint32_t>& pixels, std::vector<uint8_t>& yuv) {
+    int width = _recordWidth;
+    int height = _recordHeight;
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    size_t lumaSize = static_cast<size_t>(width) * height;
+    size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+    yuv.resize(lumaSize + 2 * chromaSize);
+    uint8_t* lumaPlane = yuv.data();
+    uint8_t* uPlane = lumaPlane + lumaSize;
+    uint8_t* vPlane = uPlane + chromaSize;
+
+    for (size_t i = 0; i < lumaSize; i++) {
+        uint32_t p = pixels[i];
+        int r = (p >> 16) & 0xFF;
+        int g = (p >> 8) & 0xFF;
+        int b = p & 0xFF;
+        lumaPlane[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    }
+    for (int cy = 0; cy < chromaHeight; cy++) {
+        int y0 = cy * 2;
+        int y1 = std::min(y0 + 1, height - 1);
+        for (int cx = 0; cx < chromaWidth; cx++) {
+            int x0 = cx * 2;
+            int x1 = std::min(x0 + 1, width - 1);
+            uint32_t quad[4] = {
+                pixels[y0 * width + x0], pixels[y0 * width + x1],
+                pixels[y1 * width + x0], pixels[y1 * width + x1]
+            };
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (uint32_t p : quad) {
+                r += (p >> 16) & 0xFF;
+                g += (p >> 8) & 0xFF;
+                b += p & 0xFF;
+            }
+            r = (r + 2) >> 2;
+            g = (g + 2) >> 2;
+            b = (b + 2) >> 2;
+            uPlane[cy * chromaWidth + cx] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            vPlane[cy * chromaWidth + cx] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+
+    if (_recordY4M) {
+        std::fputs("FRAME\n", _recordFile);
+    }
+    std::fwrite(yuv.data(), 1, yuv.size(), _recordFile);
+}
+
 extern "C" {
     arcade::IGraphical* create() {
         return new arcade::SDL2Graphical();
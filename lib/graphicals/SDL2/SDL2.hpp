@@ -7,6 +7,13 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
 
 namespace arcade {
 
@@ -42,7 +49,37 @@ private:
     int _height;
     int _cellSize;
 
+    // Recording, enabled by ARCADE_SDL2_RECORD=<file>.y4m (or .yuv for
+    // headerless I420). display() reads the frame back into a free pool
+    // buffer and hands it to the writer thread; when the pool is exhausted
+    // the frame is dropped rather than waiting on the disk.
+    static constexpr size_t RECORD_POOL_SIZE = 4;
+
+    std::string _recordPath;
+    FILE* _recordFile;
+    bool _recordY4M;
+    int _recordWidth;
+    int _recordHeight;
+    std::vector<std::vector<uint32_t>> _recordBuffers;
+    std::vector<size_t> _freeBuffers;
+    std::deque<size_t> _pendingFrames;
+    std::mutex _recordMutex;
+    std::condition_variable _recordReady;
+    std::thread _recordWriter;
+    bool _recordStopping;
+    size_t _capturedFrames;
+    size_t _writtenFrames;
+    size_t _droppedFrames;
+    double _captureSeconds;
+    double _capturePeakSeconds;
+
     // Méthodes spécifiques à SDL2
+    static TTF_Font* loadFont();
+    void startRecording();
+    void stopRecording();
+    void captureFrame();
+    void recordLoop();
+    void writeFrame(const std::vector<uint32_t>& pixels, std::vector<uint8_t>& yuv);
     void drawMenuBackground();
     void drawGameFrame();
     void createCustomTexture(const std::string& text, const Color& color, SDL_Texture** texture, int* w, int* h);
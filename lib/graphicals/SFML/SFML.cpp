@@ -4,25 +4,56 @@
 #include <unistd.h>
 #include <limits.h>
 #include <filesystem>
+#include <algorithm>
+#include <cmath>
 namespace fs = std::filesystem;
 namespace arcade {
 
-SFMLGraphical::SFMLGraphical() : _cellSize(20) {}
+SFMLGraphical::SFMLGraphical() : _cellSize(20), _batch(sf::Triangles), _fontLoaded(false) {}
 
 SFMLGraphical::~SFMLGraphical() {
     close();
 }
 
 void SFMLGraphical::init(int width, int height, const std::string &title) {
+    // Font parsing only needs FreeType, so it runs while the window and its
+    // GL context are being created instead of stalling the first drawText.
+    std::future<bool> font;
+    if (!_fontLoaded) {
+        font = std::async(std::launch::async, &SFMLGraphical::loadFont, this);
+    }
     _window.create(sf::VideoMode(width, height), title);
     _window.setVerticalSyncEnabled(true);
     _window.setFramerateLimit(60);
+    buildAtlas();
+    if (font.valid()) {
+        _fontLoaded = font.get();
+    }
+}
+
+bool SFMLGraphical::loadFont() {
+    const std::vector<std::string> fontPaths = {
+        "assets/fonts/DejaVuSans.ttf",
+        "../assets/fonts/DejaVuSans.ttf",
+        "lib/graphicals/SFML/font3.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
+    };
+
+    for (const auto &path : fontPaths) {
+        if (_font.loadFromFile(path)) {
+            return true;
+        }
+    }
+    std::cerr << "Error: Could not load font from any location" << std::endl;
+    return false;
 }
 
 void SFMLGraphical::close() {
     if (_window.isOpen()) {
         _window.close();
     }
+    _batch.clear();
+    _textureCache.clear();
 }
 
 bool SFMLGraphical::isOpen() const {
@@ -30,10 +61,12 @@ bool SFMLGraphical::isOpen() const {
 }
 
 void SFMLGraphical::clear() {
+    _batch.clear();
     _window.clear(sf::Color::Black);
 }
 
 void SFMLGraphical::display() {
+    flush();
     _window.display();
 }
 
@@ -51,6 +84,7 @@ EventType SFMLGraphical::getEvent() {
                 case sf::Keyboard::Left: return EventType::MOVE_LEFT;
                 case sf::Keyboard::Right: return EventType::MOVE_RIGHT;
                 case sf::Keyboard::Enter: return EventType::ACTION;
+                case sf::Keyboard::Z: return EventType::REWIND;
                 default: return EventType::NONE;
             }
         }
@@ -59,56 +93,39 @@ EventType SFMLGraphical::getEvent() {
 }
 
 void SFMLGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color) {
-    sf::RectangleShape rectangle(sf::Vector2f(width, height));
-    rectangle.setPosition(pos.x, pos.y);
-    rectangle.setFillColor(sf::Color(color.r, color.g, color.b, color.a));
-    _window.draw(rectangle);
+    float solid = SOLID_TEXTURE_X + SOLID_TEXTURE_SIZE / 2.0f;
+    appendQuad(pos.x, pos.y, width, height, sf::Color(color.r, color.g, color.b, color.a),
+               solid, SOLID_TEXTURE_SIZE / 2.0f, 0, 0);
 }
 
 void SFMLGraphical::drawCircle(const Position &pos, int radius, const Color &color) {
-    sf::CircleShape circle(radius);
-    circle.setPosition(pos.x, pos.y);
-    circle.setFillColor(sf::Color(color.r, color.g, color.b, color.a));
-    _window.draw(circle);
+    appendQuad(pos.x, pos.y, radius * 2, radius * 2, sf::Color(color.r, color.g, color.b, color.a),
+               0, 0, CIRCLE_TEXTURE_SIZE, CIRCLE_TEXTURE_SIZE);
 }
 
 void SFMLGraphical::drawSprite(const Sprite &sprite) {
-    sf::Texture texture;
-    if (!texture.loadFromFile(sprite.path)) {
-        std::cerr << "Failed to load sprite: " << sprite.path << std::endl;
-        return;
+    auto it = _textureCache.find(sprite.path);
+    if (it == _textureCache.end()) {
+        sf::Texture texture;
+        if (!texture.loadFromFile(sprite.path)) {
+            std::cerr << "Failed to load sprite: " << sprite.path << std::endl;
+            return;
+        }
+        it = _textureCache.emplace(sprite.path, std::move(texture)).first;
     }
-    sf::Sprite sfSprite(texture);
+    flush();
+    sf::Sprite sfSprite(it->second);
     sfSprite.setPosition(sprite.position.x, sprite.position.y);
     _window.draw(sfSprite);
 }
 
 void SFMLGraphical::drawText(const Text &text) {
-    static sf::Font font;
-    static bool fontLoaded = false;
-
-    if (!fontLoaded) {
-        const std::vector<std::string> fontPaths = {
-            "assets/fonts/DejaVuSans.ttf",
-            "../assets/fonts/DejaVuSans.ttf",
-            "lib/graphicals/SFML/font3.ttf",
-            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
-        };
-
-        for (const auto &path : fontPaths) {
-            if (font.loadFromFile(path)) {
-                fontLoaded = true;
-                break;
-            }
-        }
-
-        if (!fontLoaded) {
-            std::cerr << "Error: Could not load font from any location" << std::endl;
-            return;
-        }
+    if (!_fontLoaded) {
+        return;
     }
 
-    sf::Text sfText(text.content, font, text.size);
+    flush();
+    sf::Text sfText(text.content, _font, text.size);
     sfText.setPosition(text.position.x, text.position.y);
     sfText.setFillColor(sf::Color(text.color.r, text.color.g, text.color.b, text.color.a));
     _window.draw(sfText);
@@ -126,4 +143,55 @@ std::string SFMLGraphical::getName() const {
     return "SFML";
 }
 
+void SFMLGraphical::buildAtlas() {
+    const unsigned int width = SOLID_TEXTURE_X + SOLID_TEXTURE_SIZE;
+    const float center = CIRCLE_TEXTURE_SIZE / 2.0f;
+    sf::Image image;
+
+    image.create(width, CIRCLE_TEXTURE_SIZE, sf::Color::Transparent);
+    for (unsigned int y = 0; y < CIRCLE_TEXTURE_SIZE; ++y) {
+        for (unsigned int x = 0; x < CIRCLE_TEXTURE_SIZE; ++x) {
+            float dx = x + 0.5f - center;
+            float dy = y + 0.5f - center;
+            float coverage = center - std::sqrt(dx * dx + dy * dy) + 0.5f;
+            coverage = std::max(0.0f, std::min(1.0f, coverage));
+            image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(coverage * 255)));
+        }
+    }
+    for (unsigned int y = 0; y < SOLID_TEXTURE_SIZE; ++y) {
+        for (unsigned int x = SOLID_TEXTURE_X; x < width; ++x) {
+            image.setPixel(x, y, sf::Color::White);
+        }
+    }
+    if (!_atlas.loadFromImage(image)) {
+        std::cerr << "Error: Could not create SFML shape atlas" << std::endl;
+    }
+    _atlas.setSmooth(true);
+}
+
+void SFMLGraphical::appendQuad(float x, float y, float width, float height, const sf::Color &color,
+                               float u, float v, float uvWidth, float uvHeight) {
+    sf::Vertex topLeft(sf::Vector2f(x, y), color, sf::Vector2f(u, v));
+    sf::Vertex topRight(sf::Vector2f(x + width, y), color, sf::Vector2f(u + uvWidth, v));
+    sf::Vertex bottomRight(sf::Vector2f(x + width, y + height), color, sf::Vector2f(u + uvWidth, v + uvHeight));
+    sf::Vertex bottomLeft(sf::Vector2f(x, y + height), color, sf::Vector2f(u, v + uvHeight));
+
+    _batch.append(topLeft);
+    _batch.append(topRight);
+    _batch.append(bottomRight);
+    _batch.append(topLeft);
+    _batch.append(bottomRight);
+    _batch.append(bottomLeft);
+}
+
+void SFMLGraphical::flush() {
+    if (_batch.getVertexCount() == 0) {
+        return;
+    }
+    sf::RenderStates states;
+    states.texture = &_atlas;
+    _window.draw(_batch, states);
+    _batch.clear();
+}
+
 }
@@ -5,6 +5,7 @@
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <map>
+#include <future>
 
 namespace arcade {
 
@@ -32,8 +33,31 @@ public:
     std::string getName() const override;
 
 private:
+    // Side of the anti-aliased circle stamped into the atlas; a solid
+    // texel block sits right of it so rectangles share the same texture.
+    // The transparent gap between them keeps smoothed sampling at the
+    // circle's right edge from bleeding the solid block into it.
+    static constexpr unsigned int CIRCLE_TEXTURE_SIZE = 64;
+    static constexpr unsigned int ATLAS_GAP = 2;
+    static constexpr unsigned int SOLID_TEXTURE_X = CIRCLE_TEXTURE_SIZE + ATLAS_GAP;
+    static constexpr unsigned int SOLID_TEXTURE_SIZE = 4;
+
     sf::RenderWindow _window;
     int _cellSize;
+    // Every rectangle and circle of the frame goes into this one textured
+    // triangle list, so a frame costs a single draw call whatever the number
+    // of walls, dots or segments, and painter's order is kept.
+    sf::VertexArray _batch;
+    sf::Texture _atlas;
+    std::map<std::string, sf::Texture> _textureCache;
+    sf::Font _font;
+    bool _fontLoaded;
+
+    bool loadFont();
+    void buildAtlas();
+    void appendQuad(float x, float y, float width, float height, const sf::Color &color,
+                    float u, float v, float uvWidth, float uvHeight);
+    void flush();
 };
 
 extern "C" {
@@ -0,0 +1,593 @@
+#include "Soft.hpp"
+#include "SoftFont.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SOFT_HAS_X86 1
+#endif
+
+namespace arcade {
+
+namespace {
+
+constexpr uint32_t SHARED_MAGIC = 0x42465341; // "ASFB"
+
+// Channel blend shared by every kernel: (s * a + d * (255 - a)) / 255,
+// rounded, with the result forced opaque.
+uint32_t blendPixel(uint32_t dst, uint32_t src, uint32_t alpha) {
+    uint32_t inverse = 255 - alpha;
+    uint32_t out = 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t t = ((src >> shift) & 0xFF) * alpha + ((dst >> shift) & 0xFF) * inverse + 128;
+        out |= (((t + (t >> 8)) >> 8) & 0xFF) << shift;
+    }
+    return out;
+}
+
+void fillScalar(uint32_t *dst, int count, uint32_t color) {
+    std::fill_n(dst, count, color);
+}
+
+void blendScalar(uint32_t *dst, int count, uint32_t color, uint32_t alpha) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = blendPixel(dst[i], color, alpha);
+    }
+}
+
+#ifdef SOFT_HAS_X86
+
+__attribute__((target("sse2")))
+void fillSSE2(uint32_t *dst, int count, uint32_t color) {
+    __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), value);
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+// Blends four pixels. Always inlined so that inside the AVX2 kernel it is
+// VEX-encoded too; calling legacy SSE code from AVX code costs a state
+// transition on every span tail.
+__attribute__((target("sse2"), always_inline)) inline
+__m128i blendFour(__m128i pixels, __m128i srcTerm, __m128i inverse, __m128i opaque) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse), srcTerm);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse), srcTerm);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_or_si128(_mm_packus_epi16(lo, hi), opaque);
+}
+
+__attribute__((target("sse2")))
+void blendSSE2(uint32_t *dst, int count, uint32_t color, uint32_t alpha) {
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), _mm_setzero_si128());
+    const __m128i srcTerm = _mm_add_epi16(_mm_mullo_epi16(src, _mm_set1_epi16(static_cast<short>(alpha))),
+                                          _mm_set1_epi16(128));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), blendFour(pixels, srcTerm, inverse, opaque));
+    }
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(dst[i], color, alpha);
+    }
+}
+
+__attribute__((target("avx2")))
+void fillAVX2(uint32_t *dst, int count, uint32_t color) {
+    __m256i value = _mm256_set1_epi32(static_cast<int>(color));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), value);
+    }
+    if (i + 4 <= count) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_castsi256_si128(value));
+        i += 4;
+    }
+    for (; i < count; ++i) {
+        dst[i] = color;
+    }
+}
+
+__attribute__((target("avx2")))
+void blendAVX2(uint32_t *dst, int count, uint32_t color, uint32_t alpha) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(color)), zero);
+    const __m256i srcTerm = _mm256_add_epi16(_mm256_mullo_epi16(src, _mm256_set1_epi16(static_cast<short>(alpha))),
+                                             _mm256_set1_epi16(128));
+    const __m256i inverse = _mm256_set1_epi16(static_cast<short>(255 - alpha));
+    const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    int i = 0;
+
+    // unpack and pack both work per 128-bit lane, so pixel order survives.
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), inverse), srcTerm);
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), inverse), srcTerm);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                            _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                         blendFour(pixels, _mm256_castsi256_si128(srcTerm), _mm256_castsi256_si128(inverse),
+                                   _mm256_castsi256_si128(opaque)));
+    }
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(dst[i], color, alpha);
+    }
+}
+
+#endif
+
+uint32_t toPixel(const Color &color) {
+    return 0xFF000000u | (static_cast<uint32_t>(color.r) << 16) | (static_cast<uint32_t>(color.g) << 8) | color.b;
+}
+
+}
+
+SoftGraphical::SoftGraphical() :
+    _isRunning(false),
+    _width(0),
+    _height(0),
+    _cellSize(20),
+    _tilesX(0),
+    _tilesY(0),
+    _clearPending(false),
+    _pixels(nullptr),
+    _fill(fillScalar),
+    _blend(blendScalar),
+    _kernelName("scalar"),
+    _outputMode(OutputMode::NONE),
+    _shared(nullptr),
+    _sharedSize(0),
+    _frameId(0),
+    _busyWorkers(0),
+    _stopping(false),
+    _nextTile(0),
+    _frameCount(0),
+    _rasterSeconds(0) {
+    selectKernels();
+}
+
+SoftGraphical::~SoftGraphical() {
+    if (_isRunning) {
+        close();
+    }
+}
+
+void SoftGraphical::selectKernels() {
+    const char *forced = std::getenv("ARCADE_SOFT_SIMD");
+    std::string wanted = forced ? forced : "";
+
+    _fill = fillScalar;
+    _blend = blendScalar;
+    _kernelName = "scalar";
+#ifdef SOFT_HAS_X86
+    __builtin_cpu_init();
+    if (wanted != "scalar" && __builtin_cpu_supports("sse2")) {
+        _fill = fillSSE2;
+        _blend = blendSSE2;
+        _kernelName = "sse2";
+    }
+    if (wanted != "scalar" && wanted != "sse2" && __builtin_cpu_supports("avx2")) {
+        _fill = fillAVX2;
+        _blend = blendAVX2;
+        _kernelName = "avx2";
+    }
+#endif
+}
+
+void SoftGraphical::init(int width, int height, const std::string &title) {
+    (void)title;
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("Invalid framebuffer size");
+    }
+    _width = width;
+    _height = height;
+    _tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    _tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    _commands.clear();
+    _textPool.clear();
+    _clearPending = true;
+    _frameCount = 0;
+    _rasterSeconds = 0;
+
+    openOutput();
+    startWorkers();
+    _isRunning = true;
+}
+
+void SoftGraphical::close() {
+    if (!_isRunning) return;
+
+    _isRunning = false;
+    stopWorkers();
+    closeOutput();
+    if (_frameCount > 0) {
+        std::cerr << "Soft: " << _frameCount << " frames, "
+                  << static_cast<long>(_rasterSeconds * 1e6 / _frameCount) << " us/frame raster average, "
+                  << _kernelName << " kernels, " << (_workers.size() + 1) << " threads" << std::endl;
+    }
+    _workers.clear();
+}
+
+bool SoftGraphical::isOpen() const {
+    return _isRunning;
+}
+
+void SoftGraphical::openOutput() {
+    const char *config = std::getenv("ARCADE_SOFT_OUTPUT");
+    std::string output = config ? config : "none";
+    size_t pixelCount = static_cast<size_t>(_width) * _height;
+
+    _outputMode = OutputMode::NONE;
+    if (output.compare(0, 4, "ppm:") == 0 && output.size() > 4) {
+        _outputMode = OutputMode::PPM;
+        _outputPath = output.substr(4);
+        _ppmBuffer.resize(pixelCount * 3);
+    } else if (output.compare(0, 4, "shm:") == 0 && output.size() > 4) {
+        _shmName = output.substr(4);
+        if (_shmName[0] != '/') {
+            _shmName = "/" + _shmName;
+        }
+        int fd = shm_open(_shmName.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open shared memory: " + _shmName);
+        }
+        _sharedSize = sizeof(SharedHeader) + pixelCount * sizeof(uint32_t);
+        if (ftruncate(fd, _sharedSize) < 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot size shared memory: " + _shmName);
+        }
+        void *mapping = mmap(nullptr, _sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Cannot map shared memory: " + _shmName);
+        }
+        _shared = static_cast<SharedHeader *>(mapping);
+        _shared->magic = SHARED_MAGIC;
+        _shared->width = _width;
+        _shared->height = _height;
+        _shared->stride = _width * sizeof(uint32_t);
+        _shared->sequence = 0;
+        // Rasterise straight into the mapping: readers get frames with no copy.
+        _pixels = reinterpret_cast<uint32_t *>(_shared + 1);
+        _outputMode = OutputMode::SHARED_MEMORY;
+        return;
+    } else if (output != "none") {
+        std::cerr << "Warning: unknown ARCADE_SOFT_OUTPUT '" << output << "', rendering nowhere" << std::endl;
+    }
+    _framebuffer.assign(pixelCount, 0xFF000000);
+    _pixels = _framebuffer.data();
+}
+
+void SoftGraphical::closeOutput() {
+    if (_shared) {
+        munmap(_shared, _sharedSize);
+        shm_unlink(_shmName.c_str());
+        _shared = nullptr;
+    }
+    _pixels = nullptr;
+    _framebuffer.clear();
+    _ppmBuffer.clear();
+    _outputMode = OutputMode::NONE;
+}
+
+void SoftGraphical::writeOutput() {
+    if (_outputMode != OutputMode::PPM) {
+        return;
+    }
+    std::string path = _outputPath;
+    size_t marker = path.find("%d");
+    if (marker != std::string::npos) {
+        path.replace(marker, 2, std::to_string(_frameCount));
+    }
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    size_t pixelCount = static_cast<size_t>(_width) * _height;
+    unsigned char *out = _ppmBuffer.data();
+    for (size_t i = 0; i < pixelCount; ++i) {
+        *out++ = (_pixels[i] >> 16) & 0xFF;
+        *out++ = (_pixels[i] >> 8) & 0xFF;
+        *out++ = _pixels[i] & 0xFF;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", _width, _height);
+    std::fwrite(_ppmBuffer.data(), 1, _ppmBuffer.size(), file);
+    std::fclose(file);
+}
+
+void SoftGraphical::startWorkers() {
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    if (const char *forced = std::getenv("ARCADE_SOFT_THREADS")) {
+        threads = std::max(1, std::atoi(forced));
+    }
+    threads = std::min(threads, static_cast<unsigned int>(_tilesX * _tilesY));
+
+    _stopping = false;
+    _busyWorkers = 0;
+    // Workers start from frame 0, so a pool restarted by a second init()
+    // must not see the previous session's frames as new work.
+    _frameId = 0;
+    // The calling thread rasterises too, so it counts as one of them.
+    for (unsigned int i = 1; i < threads; ++i) {
+        _workers.emplace_back(&SoftGraphical::workerLoop, this);
+    }
+}
+
+void SoftGraphical::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(_poolMutex);
+        _stopping = true;
+    }
+    _workReady.notify_all();
+    for (auto &worker : _workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void SoftGraphical::workerLoop() {
+    uint64_t seenFrame = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_poolMutex);
+            _workReady.wait(lock, [this, seenFrame] { return _stopping || _frameId != seenFrame; });
+            if (_stopping) {
+                return;
+            }
+            seenFrame = _frameId;
+        }
+        rasterizeTiles();
+        {
+            std::lock_guard<std::mutex> lock(_poolMutex);
+            if (--_busyWorkers == 0) {
+                _workDone.notify_one();
+            }
+        }
+    }
+}
+
+void SoftGraphical::rasterizeTiles() {
+    int tileCount = _tilesX * _tilesY;
+    int tile;
+
+    while ((tile = _nextTile.fetch_add(1, std::memory_order_relaxed)) < tileCount) {
+        rasterizeTile(tile);
+    }
+}
+
+void SoftGraphical::span(uint32_t *row, int x0, int x1, const Command &command) {
+    if (x1 <= x0) {
+        return;
+    }
+    if (command.alpha == 255) {
+        _fill(row + x0, x1 - x0, command.color);
+    } else {
+        _blend(row + x0, x1 - x0, command.color, command.alpha);
+    }
+}
+
+void SoftGraphical::rasterizeTile(int tile) {
+    int tx0 = (tile % _tilesX) * TILE_SIZE;
+    int ty0 = (tile / _tilesX) * TILE_SIZE;
+    int tx1 = std::min(tx0 + TILE_SIZE, _width);
+    int ty1 = std::min(ty0 + TILE_SIZE, _height);
+
+    if (_clearPending) {
+        for (int y = ty0; y < ty1; ++y) {
+            _fill(_pixels + static_cast<size_t>(y) * _width + tx0, tx1 - tx0, 0xFF000000);
+        }
+    }
+
+    for (const Command &command : _commands) {
+        if (command.x1 <= tx0 || command.x0 >= tx1 || command.y1 <= ty0 || command.y0 >= ty1) {
+            continue;
+        }
+        int y0 = std::max(command.y0, ty0);
+        int y1 = std::min(command.y1, ty1);
+
+        switch (command.type) {
+            case CommandType::RECTANGLE: {
+                int x0 = std::max(command.x0, tx0);
+                int x1 = std::min(command.x1, tx1);
+                for (int y = y0; y < y1; ++y) {
+                    span(_pixels + static_cast<size_t>(y) * _width, x0, x1, command);
+                }
+                break;
+            }
+            case CommandType::CIRCLE: {
+                int r2 = command.radius * command.radius;
+                for (int y = y0; y < y1; ++y) {
+                    int dy = y - command.cy;
+                    int half = static_cast<int>(std::sqrt(static_cast<float>(r2 - dy * dy)));
+                    span(_pixels + static_cast<size_t>(y) * _width,
+                         std::max(command.cx - half, tx0), std::min(command.cx + half + 1, tx1), command);
+                }
+                break;
+            }
+            case CommandType::TEXT: {
+                int penX = command.cx;
+                const char *text = _textPool.data() + command.textOffset;
+                for (size_t i = 0; i < command.textLength && penX < tx1; ++i) {
+                    char ch = text[i];
+                    if (ch < SOFT_FONT_FIRST || ch > SOFT_FONT_LAST) {
+                        ch = '?';
+                    }
+                    const SoftGlyph &glyph = SOFT_FONT[ch - SOFT_FONT_FIRST];
+                    int advance = glyph.advance * command.scale;
+                    if (penX + advance > tx0) {
+                        for (int y = y0; y < y1; ++y) {
+                            uint16_t bits = glyph.rows[(y - command.cy) / command.scale];
+                            uint32_t *row = _pixels + static_cast<size_t>(y) * _width;
+                            // Each run of set bits becomes one span.
+                            for (int bit = 0; bits >> bit; ) {
+                                if (!((bits >> bit) & 1)) {
+                                    bit++;
+                                    continue;
+                                }
+                                int end = bit;
+                                while ((bits >> end) & 1) {
+                                    end++;
+                                }
+                                span(row, std::max(penX + bit * command.scale, tx0),
+                                     std::min(penX + end * command.scale, tx1), command);
+                                bit = end;
+                            }
+                        }
+                    }
+                    penX += advance;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void SoftGraphical::clear() {
+    _commands.clear();
+    _textPool.clear();
+    _clearPending = true;
+}
+
+void SoftGraphical::display() {
+    if (!_isRunning) return;
+
+    auto start = std::chrono::steady_clock::now();
+    if (_shared) {
+        __atomic_add_fetch(&_shared->sequence, 1, __ATOMIC_RELEASE);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_poolMutex);
+        _nextTile.store(0, std::memory_order_relaxed);
+        _busyWorkers = static_cast<int>(_workers.size());
+        _frameId++;
+    }
+    _workReady.notify_all();
+    rasterizeTiles();
+    {
+        std::unique_lock<std::mutex> lock(_poolMutex);
+        _workDone.wait(lock, [this] { return _busyWorkers == 0; });
+    }
+
+    if (_shared) {
+        __atomic_add_fetch(&_shared->sequence, 1, __ATOMIC_RELEASE);
+    }
+    _rasterSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    _commands.clear();
+    _textPool.clear();
+    _clearPending = false;
+    _frameCount++;
+    writeOutput();
+}
+
+const uint32_t *SoftGraphical::getPixels() const {
+    return _pixels;
+}
+
+EventType SoftGraphical::getEvent() {
+    return _isRunning ? EventType::NONE : EventType::QUIT;
+}
+
+void SoftGraphical::pushBox(CommandType type, int x0, int y0, int x1, int y1, const Color &color, Command &command) {
+    command.type = type;
+    command.x0 = std::max(x0, 0);
+    command.y0 = std::max(y0, 0);
+    command.x1 = std::min(x1, _width);
+    command.y1 = std::min(y1, _height);
+    command.color = toPixel(color);
+    command.alpha = color.a;
+    if (command.x0 >= command.x1 || command.y0 >= command.y1 || command.alpha == 0) {
+        return;
+    }
+    _commands.push_back(command);
+}
+
+void SoftGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color) {
+    Command command = {};
+    pushBox(CommandType::RECTANGLE, pos.x, pos.y, pos.x + width, pos.y + height, color, command);
+}
+
+void SoftGraphical::drawCircle(const Position &pos, int radius, const Color &color) {
+    Command command = {};
+    command.cx = pos.x;
+    command.cy = pos.y;
+    command.radius = radius;
+    pushBox(CommandType::CIRCLE, pos.x - radius, pos.y - radius, pos.x + radius + 1, pos.y + radius + 1,
+            color, command);
+}
+
+void SoftGraphical::drawSprite(const Sprite &sprite) {
+    drawRectangle(sprite.position, _cellSize, _cellSize, Color(255, 255, 255));
+}
+
+void SoftGraphical::drawText(const Text &text) {
+    Command command = {};
+    int width = 0;
+
+    command.scale = std::max(1, static_cast<int>(text.size + 6) / SOFT_FONT_HEIGHT);
+    for (char ch : text.content) {
+        if (ch < SOFT_FONT_FIRST || ch > SOFT_FONT_LAST) {
+            ch = '?';
+        }
+        width += SOFT_FONT[ch - SOFT_FONT_FIRST].advance * command.scale;
+    }
+    command.cx = text.position.x;
+    command.cy = text.position.y;
+    command.textOffset = _textPool.size();
+    command.textLength = text.content.size();
+    size_t before = _commands.size();
+    pushBox(CommandType::TEXT, text.position.x, text.position.y, text.position.x + width,
+            text.position.y + SOFT_FONT_HEIGHT * command.scale, text.color, command);
+    if (_commands.size() != before) {
+        _textPool += text.content;
+    }
+}
+
+void SoftGraphical::drawCell(int x, int y, const Color &color) {
+    drawRectangle(Position(x * _cellSize, y * _cellSize), _cellSize, _cellSize, color);
+}
+
+void SoftGraphical::setCellSize(int size) {
+    _cellSize = size;
+}
+
+std::string SoftGraphical::getName() const {
+    return "Soft";
+}
+
+extern "C" {
+    arcade::IGraphical* create() {
+        return new arcade::SoftGraphical();
+    }
+
+    void destroy(arcade::IGraphical* obj) {
+        delete obj;
+    }
+}
+
+}
@@ -0,0 +1,143 @@
+#ifndef SOFT_HPP_
+#define SOFT_HPP_
+
+#include "../../../src/interfaces/IGraphical.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace arcade {
+
+// CPU framebuffer backend. Draw calls are recorded, then display() splits
+// the screen into tiles that worker threads rasterise in parallel with
+// SSE2/AVX2 span kernels picked at runtime. Configured through:
+//   ARCADE_SOFT_OUTPUT  none (default), ppm:<path> or shm:<name>
+//   ARCADE_SOFT_THREADS number of rasteriser threads
+//   ARCADE_SOFT_SIMD    scalar, sse2 or avx2 to force a kernel
+class SoftGraphical : public IGraphical {
+public:
+    SoftGraphical();
+    ~SoftGraphical() override;
+
+    void init(int width, int height, const std::string &title) override;
+    void close() override;
+    bool isOpen() const override;
+    void clear() override;
+    void display() override;
+
+    EventType getEvent() override;
+
+    void drawRectangle(const Position &pos, int width, int height, const Color &color) override;
+    void drawCircle(const Position &pos, int radius, const Color &color) override;
+    void drawSprite(const Sprite &sprite) override;
+    void drawText(const Text &text) override;
+
+    void drawCell(int x, int y, const Color &color) override;
+    void setCellSize(int size) override;
+
+    std::string getName() const override;
+
+    // Pixels of the last displayed frame, 0xAARRGGBB, row-major.
+    const uint32_t *getPixels() const;
+
+    using FillSpan = void (*)(uint32_t *dst, int count, uint32_t color);
+    using BlendSpan = void (*)(uint32_t *dst, int count, uint32_t color, uint32_t alpha);
+
+private:
+    enum class CommandType : uint8_t {
+        RECTANGLE,
+        CIRCLE,
+        TEXT
+    };
+
+    enum class OutputMode {
+        NONE,
+        PPM,
+        SHARED_MEMORY
+    };
+
+    // Bounding box is [x0, x1) x [y0, y1) in pixels, already clipped to the
+    // screen, so tiles can reject a command with four comparisons.
+    struct Command {
+        CommandType type;
+        int x0, y0, x1, y1;
+        int cx, cy, radius;
+        uint32_t color;
+        uint32_t alpha;
+        size_t textOffset;
+        size_t textLength;
+        int scale;
+    };
+
+    // Layout of the shared-memory output: this header, then the pixels.
+    // sequence is odd while a frame is being rasterised.
+    struct SharedHeader {
+        uint32_t magic;
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride;
+        uint64_t sequence;
+    };
+
+    static constexpr int TILE_SIZE = 64;
+
+    bool _isRunning;
+    int _width;
+    int _height;
+    int _cellSize;
+    int _tilesX;
+    int _tilesY;
+    bool _clearPending;
+    uint32_t *_pixels;
+    std::vector<uint32_t> _framebuffer;
+    std::vector<Command> _commands;
+    std::string _textPool;
+
+    FillSpan _fill;
+    BlendSpan _blend;
+    std::string _kernelName;
+
+    OutputMode _outputMode;
+    std::string _outputPath;
+    std::vector<unsigned char> _ppmBuffer;
+    std::string _shmName;
+    SharedHeader *_shared;
+    size_t _sharedSize;
+
+    std::vector<std::thread> _workers;
+    std::mutex _poolMutex;
+    std::condition_variable _workReady;
+    std::condition_variable _workDone;
+    uint64_t _frameId;
+    int _busyWorkers;
+    bool _stopping;
+    std::atomic<int> _nextTile;
+
+    size_t _frameCount;
+    double _rasterSeconds;
+
+    void selectKernels();
+    void openOutput();
+    void closeOutput();
+    void writeOutput();
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop();
+    void rasterizeTiles();
+    void rasterizeTile(int tile);
+    void span(uint32_t *row, int x0, int x1, const Command &command);
+    void pushBox(CommandType type, int x0, int y0, int x1, int y1, const Color &color, Command &command);
+};
+
+extern "C" {
+    arcade::IGraphical* create();
+    void destroy(arcade::IGraphical* obj);
+}
+
+} // namespace arcade
+
+#endif // SOFT_HPP_
@@ -0,0 +1,120 @@
+#ifndef SOFT_FONT_HPP_
+#define SOFT_FONT_HPP_
+
+#include <cstdint>
+
+namespace arcade {
+
+// Proportional 12px bitmap font for printable ASCII, rasterised once from
+// assets/fonts/DejaVuSans.ttf so the software backend needs no font
+// library. Bit n of a row is pixel n from the left of the glyph.
+struct SoftGlyph {
+    uint8_t advance;
+    uint16_t rows[12];
+};
+
+static constexpr int SOFT_FONT_HEIGHT = 12;
+static constexpr char SOFT_FONT_FIRST = 32;
+static constexpr char SOFT_FONT_LAST = 126;
+
+static const SoftGlyph SOFT_FONT[SOFT_FONT_LAST - SOFT_FONT_FIRST + 1] = {
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // ' '
+    { 5, {0x0000, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000}}, // '!'
+    { 5, {0x0000, 0x000a, 0x000a, 0x000a, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '"'
+    {10, {0x0000, 0x0000, 0x0090, 0x0050, 0x01fc, 0x0048, 0x0048, 0x00fe, 0x0028, 0x0024, 0x0000, 0x0000}}, // '#'
+    { 8, {0x0000, 0x0010, 0x0038, 0x0054, 0x0014, 0x001c, 0x0070, 0x0050, 0x0054, 0x0038, 0x0010, 0x0010}}, // '$'
+    {11, {0x0000, 0x0086, 0x0049, 0x0049, 0x0029, 0x01b6, 0x0250, 0x0248, 0x0248, 0x0184, 0x0000, 0x0000}}, // '%'
+    {10, {0x0000, 0x0018, 0x0024, 0x0004, 0x000c, 0x0114, 0x0122, 0x00c2, 0x0046, 0x01bc, 0x0000, 0x0000}}, // '&'
+    { 3, {0x0000, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '\''
+    { 5, {0x000c, 0x0004, 0x0004, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0004, 0x0004, 0x000c, 0x0000}}, // '('
+    { 5, {0x0006, 0x0004, 0x0004, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0004, 0x0004, 0x0006, 0x0000}}, // ')'
+    { 6, {0x0000, 0x0008, 0x002a, 0x001c, 0x001c, 0x002a, 0x0008, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '*'
+    {10, {0x0000, 0x0000, 0x0000, 0x0010, 0x0010, 0x0010, 0x00fe, 0x0010, 0x0010, 0x0010, 0x0000, 0x0000}}, // '+'
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0000}}, // ','
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x000e, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '-'
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0002, 0x0002, 0x0000, 0x0000}}, // '.'
+    { 4, {0x0000, 0x0008, 0x0008, 0x0004, 0x0004, 0x0004, 0x0002, 0x0002, 0x0002, 0x0001, 0x0001, 0x0000}}, // '/'
+    { 8, {0x0000, 0x003c, 0x0024, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0024, 0x003c, 0x0000, 0x0000}}, // '0'
+    { 8, {0x0000, 0x000e, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x003e, 0x0000, 0x0000}}, // '1'
+    { 8, {0x0000, 0x003c, 0x0062, 0x0040, 0x0040, 0x0020, 0x0010, 0x0008, 0x0004, 0x007e, 0x0000, 0x0000}}, // '2'
+    { 8, {0x0000, 0x003c, 0x0042, 0x0040, 0x0040, 0x0038, 0x0040, 0x0040, 0x0042, 0x003c, 0x0000, 0x0000}}, // '3'
+    { 8, {0x0000, 0x0030, 0x0030, 0x0028, 0x0024, 0x0024, 0x0022, 0x007e, 0x0020, 0x0020, 0x0000, 0x0000}}, // '4'
+    { 8, {0x0000, 0x003e, 0x0002, 0x0002, 0x003e, 0x0060, 0x0040, 0x0040, 0x0062, 0x003c, 0x0000, 0x0000}}, // '5'
+    { 8, {0x0000, 0x0038, 0x0044, 0x0002, 0x003a, 0x0066, 0x0042, 0x0042, 0x0064, 0x003c, 0x0000, 0x0000}}, // '6'
+    { 8, {0x0000, 0x007e, 0x0040, 0x0020, 0x0020, 0x0010, 0x0010, 0x0008, 0x0008, 0x0004, 0x0000, 0x0000}}, // '7'
+    { 8, {0x0000, 0x003c, 0x0042, 0x0042, 0x0042, 0x003c, 0x0042, 0x0042, 0x0042, 0x003c, 0x0000, 0x0000}}, // '8'
+    { 8, {0x0000, 0x003c, 0x0026, 0x0042, 0x0042, 0x0066, 0x005c, 0x0040, 0x0022, 0x001c, 0x0000, 0x0000}}, // '9'
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0002, 0x0002, 0x0000, 0x0000, 0x0002, 0x0002, 0x0000, 0x0000}}, // ':'
+    { 4, {0x0000, 0x0000, 0x0000, 0x0000, 0x0002, 0x0002, 0x0000, 0x0000, 0x0002, 0x0002, 0x0002, 0x0000}}, // ';'
+    {10, {0x0000, 0x0000, 0x0000, 0x0180, 0x00f0, 0x000e, 0x000e, 0x00f0, 0x0180, 0x0000, 0x0000, 0x0000}}, // '<'
+    {10, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x01fe, 0x0000, 0x01fe, 0x0000, 0x0000, 0x0000, 0x0000}}, // '='
+    {10, {0x0000, 0x0000, 0x0000, 0x0006, 0x003c, 0x01c0, 0x01c0, 0x003c, 0x0006, 0x0000, 0x0000, 0x0000}}, // '>'
+    { 6, {0x0000, 0x000e, 0x0011, 0x0010, 0x0008, 0x0004, 0x0004, 0x0000, 0x0004, 0x0004, 0x0000, 0x0000}}, // '?'
+    {13, {0x0000, 0x01f0, 0x0608, 0x0404, 0x09e2, 0x0912, 0x0912, 0x0512, 0x03e2, 0x0004, 0x0208, 0x01f0}}, // '@'
+    { 8, {0x0000, 0x0018, 0x0018, 0x0024, 0x0024, 0x0024, 0x0042, 0x007e, 0x0042, 0x0081, 0x0000, 0x0000}}, // 'A'
+    { 8, {0x0000, 0x003e, 0x0042, 0x0042, 0x0042, 0x003e, 0x0042, 0x0042, 0x0042, 0x003e, 0x0000, 0x0000}}, // 'B'
+    { 8, {0x0000, 0x0038, 0x0044, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0044, 0x0038, 0x0000, 0x0000}}, // 'C'
+    { 9, {0x0000, 0x003e, 0x0042, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x0042, 0x003e, 0x0000, 0x0000}}, // 'D'
+    { 8, {0x0000, 0x007e, 0x0002, 0x0002, 0x0002, 0x007e, 0x0002, 0x0002, 0x0002, 0x007e, 0x0000, 0x0000}}, // 'E'
+    { 7, {0x0000, 0x003e, 0x0002, 0x0002, 0x0002, 0x003e, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'F'
+    { 9, {0x0000, 0x0078, 0x0084, 0x0002, 0x0002, 0x00e2, 0x0082, 0x0082, 0x0084, 0x0078, 0x0000, 0x0000}}, // 'G'
+    { 9, {0x0000, 0x0082, 0x0082, 0x0082, 0x0082, 0x00fe, 0x0082, 0x0082, 0x0082, 0x0082, 0x0000, 0x0000}}, // 'H'
+    { 3, {0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'I'
+    { 3, {0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0001}}, // 'J'
+    { 7, {0x0000, 0x0042, 0x0022, 0x0012, 0x000a, 0x0006, 0x000a, 0x0012, 0x0022, 0x0042, 0x0000, 0x0000}}, // 'K'
+    { 6, {0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x003e, 0x0000, 0x0000}}, // 'L'
+    {10, {0x0000, 0x0102, 0x0186, 0x0186, 0x014a, 0x014a, 0x0132, 0x0132, 0x0102, 0x0102, 0x0000, 0x0000}}, // 'M'
+    { 9, {0x0000, 0x0086, 0x0086, 0x008a, 0x008a, 0x0092, 0x00a2, 0x00a2, 0x00c2, 0x00c2, 0x0000, 0x0000}}, // 'N'
+    { 9, {0x0000, 0x0038, 0x0044, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x0044, 0x0038, 0x0000, 0x0000}}, // 'O'
+    { 8, {0x0000, 0x003e, 0x0042, 0x0042, 0x0042, 0x003e, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'P'
+    { 9, {0x0000, 0x0038, 0x0044, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x0044, 0x0038, 0x0020, 0x0040}}, // 'Q'
+    { 8, {0x0000, 0x003e, 0x0042, 0x0042, 0x0042, 0x003e, 0x0022, 0x0042, 0x0042, 0x0082, 0x0000, 0x0000}}, // 'R'
+    { 8, {0x0000, 0x003c, 0x0042, 0x0002, 0x0002, 0x003c, 0x0040, 0x0040, 0x0042, 0x003c, 0x0000, 0x0000}}, // 'S'
+    { 7, {0x0000, 0x007f, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0008, 0x0000, 0x0000}}, // 'T'
+    { 9, {0x0000, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x0082, 0x00c6, 0x007c, 0x0000, 0x0000}}, // 'U'
+    { 8, {0x0000, 0x0081, 0x0081, 0x0042, 0x0042, 0x0042, 0x0024, 0x0024, 0x0018, 0x0018, 0x0000, 0x0000}}, // 'V'
+    {11, {0x0000, 0x0421, 0x0222, 0x0222, 0x0252, 0x0154, 0x0154, 0x0154, 0x0088, 0x0088, 0x0000, 0x0000}}, // 'W'
+    { 7, {0x0000, 0x0063, 0x0022, 0x0014, 0x0014, 0x0008, 0x0014, 0x0014, 0x0022, 0x0041, 0x0000, 0x0000}}, // 'X'
+    { 7, {0x0000, 0x0041, 0x0022, 0x0022, 0x0014, 0x0014, 0x0008, 0x0008, 0x0008, 0x0008, 0x0000, 0x0000}}, // 'Y'
+    { 9, {0x0000, 0x00fe, 0x0080, 0x0040, 0x0020, 0x0010, 0x0008, 0x0004, 0x0002, 0x00fe, 0x0000, 0x0000}}, // 'Z'
+    { 5, {0x0000, 0x000c, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x000c}}, // '['
+    { 4, {0x0000, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0004, 0x0004, 0x0004, 0x0008, 0x0008, 0x0000}}, // '\\'
+    { 5, {0x0000, 0x0006, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0006}}, // ']'
+    {10, {0x0000, 0x0030, 0x0048, 0x0084, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '^'
+    { 6, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '_'
+    { 6, {0x0004, 0x0008, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '`'
+    { 8, {0x0000, 0x0000, 0x0000, 0x003c, 0x0042, 0x0040, 0x007c, 0x0042, 0x0062, 0x005c, 0x0000, 0x0000}}, // 'a'
+    { 8, {0x0002, 0x0002, 0x0002, 0x003e, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003e, 0x0000, 0x0000}}, // 'b'
+    { 7, {0x0000, 0x0000, 0x0000, 0x001c, 0x0026, 0x0002, 0x0002, 0x0002, 0x0026, 0x001c, 0x0000, 0x0000}}, // 'c'
+    { 8, {0x0040, 0x0040, 0x0040, 0x007c, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007c, 0x0000, 0x0000}}, // 'd'
+    { 8, {0x0000, 0x0000, 0x0000, 0x003c, 0x0066, 0x0042, 0x007e, 0x0002, 0x0046, 0x003c, 0x0000, 0x0000}}, // 'e'
+    { 4, {0x000c, 0x0002, 0x0002, 0x000f, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'f'
+    { 8, {0x0000, 0x0000, 0x0000, 0x007c, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007c, 0x0040, 0x0064}}, // 'g'
+    { 8, {0x0002, 0x0002, 0x0002, 0x003a, 0x0046, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0000, 0x0000}}, // 'h'
+    { 3, {0x0000, 0x0002, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'i'
+    { 3, {0x0000, 0x0002, 0x0000, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002}}, // 'j'
+    { 7, {0x0002, 0x0002, 0x0002, 0x0022, 0x0012, 0x000a, 0x0006, 0x000a, 0x0012, 0x0022, 0x0000, 0x0000}}, // 'k'
+    { 3, {0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'l'
+    {11, {0x0000, 0x0000, 0x0000, 0x01de, 0x0222, 0x0222, 0x0222, 0x0222, 0x0222, 0x0222, 0x0000, 0x0000}}, // 'm'
+    { 8, {0x0000, 0x0000, 0x0000, 0x003a, 0x0046, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0000, 0x0000}}, // 'n'
+    { 8, {0x0000, 0x0000, 0x0000, 0x003c, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003c, 0x0000, 0x0000}}, // 'o'
+    { 8, {0x0000, 0x0000, 0x0000, 0x003e, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x003e, 0x0002, 0x0002}}, // 'p'
+    { 8, {0x0000, 0x0000, 0x0000, 0x007c, 0x0066, 0x0042, 0x0042, 0x0042, 0x0066, 0x007c, 0x0040, 0x0040}}, // 'q'
+    { 5, {0x0000, 0x0000, 0x0000, 0x001a, 0x0006, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x0000, 0x0000}}, // 'r'
+    { 7, {0x0000, 0x0000, 0x0000, 0x001c, 0x0022, 0x0002, 0x001c, 0x0020, 0x0022, 0x001c, 0x0000, 0x0000}}, // 's'
+    { 5, {0x0000, 0x0002, 0x0002, 0x000f, 0x0002, 0x0002, 0x0002, 0x0002, 0x0002, 0x000e, 0x0000, 0x0000}}, // 't'
+    { 8, {0x0000, 0x0000, 0x0000, 0x0042, 0x0042, 0x0042, 0x0042, 0x0042, 0x0062, 0x005c, 0x0000, 0x0000}}, // 'u'
+    { 6, {0x0000, 0x0000, 0x0000, 0x0021, 0x0021, 0x0012, 0x0012, 0x0012, 0x000c, 0x000c, 0x0000, 0x0000}}, // 'v'
+    { 9, {0x0000, 0x0000, 0x0000, 0x0111, 0x0111, 0x00aa, 0x00aa, 0x00aa, 0x0044, 0x0044, 0x0000, 0x0000}}, // 'w'
+    { 6, {0x0000, 0x0000, 0x0000, 0x0021, 0x0012, 0x0012, 0x000c, 0x0012, 0x0012, 0x0021, 0x0000, 0x0000}}, // 'x'
+    { 6, {0x0000, 0x0000, 0x0000, 0x0021, 0x0021, 0x0012, 0x0012, 0x0014, 0x000c, 0x0008, 0x0008, 0x0004}}, // 'y'
+    { 5, {0x0000, 0x0000, 0x0000, 0x001f, 0x0010, 0x0008, 0x0004, 0x0002, 0x0001, 0x001f, 0x0000, 0x0000}}, // 'z'
+    { 8, {0x0000, 0x0070, 0x0010, 0x0010, 0x0010, 0x0010, 0x000c, 0x0010, 0x0010, 0x0010, 0x0010, 0x0070}}, // '{'
+    { 4, {0x0000, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004, 0x0004}}, // '|'
+    { 8, {0x0000, 0x000e, 0x0008, 0x0008, 0x0008, 0x0008, 0x0030, 0x0008, 0x0008, 0x0008, 0x0008, 0x000e}}, // '}'
+    {10, {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x011c, 0x00e2, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000}}, // '~'
+};
+
+}
+
+#endif // SOFT_FONT_HPP_
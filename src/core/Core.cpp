@@ -5,32 +5,122 @@
 #include <chrono>
 #include <thread>
 #include <filesystem>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
 #include "DLLoader.hpp"
 
 namespace arcade
 {
 
     Core::Core(const std::string &initialGraphical, const std::string &initialGame)
-        : _currentGraphicalIndex(0), _currentGameIndex(0), _state(GameState::MENU)
+        : _currentGraphicalIndex(0), _currentGameIndex(0), _state(GameState::MENU),
+          _initialGraphical(initialGraphical), _initialGame(initialGame), _captureTimer(0), _rewindBack(0),
+          _rewindHold(0), _bootStart(std::chrono::steady_clock::now()), _firstFrameShown(false), _maxSpeed(false),
+          _inputTicks(0), _inputEvents(0), _replayClock(0), _finalState(0)
     {
-        loadLibraries();
+        std::promise<void> librariesReady;
+        _librariesReady = librariesReady.get_future();
+        _bootWorker = std::async(std::launch::async, &Core::bootWorker, this, std::move(librariesReady));
+    }
+
+    Core::~Core()
+    {
+        stop();
+    }
+
+    static bool isSameLibrary(const std::string &lhs, const std::string &rhs)
+    {
+        std::error_code error;
+        return lhs == rhs || std::filesystem::equivalent(lhs, rhs, error);
+    }
+
+    void Core::bootWorker(std::promise<void> librariesReady)
+    {
+        std::string gamePath;
+        try
+        {
+            loadLibraries();
+
+            auto graphicalIt = std::find_if(_graphicalLibs.begin(), _graphicalLibs.end(),
+                [this](const std::string &path) { return isSameLibrary(path, _initialGraphical); });
+            if (graphicalIt != _graphicalLibs.end())
+            {
+                _currentGraphicalIndex = std::distance(_graphicalLibs.begin(), graphicalIt);
+            }
+
+            auto gameIt = std::find(_gameLibs.begin(), _gameLibs.end(), _initialGame);
+            if (gameIt != _gameLibs.end())
+            {
+                _currentGameIndex = std::distance(_gameLibs.begin(), gameIt);
+            }
+            if (!_gameLibs.empty())
+            {
+                gamePath = _gameLibs[_currentGameIndex];
+            }
+            recordBootPhase("libraries scanned");
+            librariesReady.set_value();
+        }
+        catch (...)
+        {
+            librariesReady.set_exception(std::current_exception());
+            return;
+        }
 
-        auto graphicalIt = std::find(_graphicalLibs.begin(), _graphicalLibs.end(), initialGraphical);
-        if (graphicalIt != _graphicalLibs.end())
+        // The menu preselects this game, so load it and parse its map now;
+        // pressing ENTER then only flips its state. On failure the regular
+        // load path tries again when the game is started.
+        if (gamePath.empty())
+            return;
+        try
+        {
+            auto loader = std::make_unique<DLLoader<IGame>>(gamePath);
+            auto game = loader->getInstance();
+            if (game)
+            {
+                game->init();
+                game->snapshot(_preparedStart);
+                game->stop();
+                _preparedGame = std::move(loader);
+                recordBootPhase("game prepared");
+            }
+        }
+        catch (const std::exception &e)
         {
-            _currentGraphicalIndex = std::distance(_graphicalLibs.begin(), graphicalIt);
+            std::cerr << "Error preparing game: " << e.what() << std::endl;
         }
+    }
 
-        auto gameIt = std::find(_gameLibs.begin(), _gameLibs.end(), initialGame);
-        if (gameIt != _gameLibs.end())
+    void Core::waitForLibraries()
+    {
+        if (_librariesReady.valid())
         {
-            _currentGameIndex = std::distance(_gameLibs.begin(), gameIt);
+            _librariesReady.get();
         }
     }
 
-    Core::~Core()
+    void Core::recordBootPhase(const std::string &phase)
     {
-        stop();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _bootStart).count();
+        std::lock_guard<std::mutex> lock(_bootMutex);
+        _bootPhases.emplace_back(phase, elapsed);
+    }
+
+    void Core::reportBoot()
+    {
+        std::lock_guard<std::mutex> lock(_bootMutex);
+        if (_bootPhases.empty())
+            return;
+        std::sort(_bootPhases.begin(), _bootPhases.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.second < rhs.second; });
+        std::cerr << "Boot:";
+        for (const auto &phase : _bootPhases)
+        {
+            std::cerr << " " << phase.first << " " << std::fixed << std::setprecision(1) << phase.second << " ms"
+                      << (&phase == &_bootPhases.back() ? "" : ",");
+        }
+        std::cerr << std::endl;
+        _bootPhases.clear();
     }
 
     void Core::loadLibraries()
@@ -48,7 +138,10 @@ namespace arcade
 
             if (filename.find("arcade_ncurses") != std::string::npos ||
                 filename.find("arcade_sfml") != std::string::npos ||
-                filename.find("arcade_sdl2") != std::string::npos)
+                filename.find("arcade_sdl2") != std::string::npos ||
+                filename.find("arcade_ansi") != std::string::npos ||
+                filename.find("arcade_soft") != std::string::npos ||
+                filename.find("arcade_null") != std::string::npos)
             {
                 _graphicalLibs.push_back(filepath);
             }
@@ -68,18 +161,30 @@ namespace arcade
     {
         try
         {
-            if (!_graphicalLibs.empty())
+            _graphicalLoader = std::make_unique<DLLoader<IGraphical>>(_initialGraphical);
+            auto graphical = _graphicalLoader->getInstance();
+            if (!graphical)
             {
-                _graphicalLoader = std::make_unique<DLLoader<IGraphical>>(_graphicalLibs[_currentGraphicalIndex]);
-                auto graphical = _graphicalLoader->getInstance();
-                if (!graphical)
+                throw std::runtime_error("Failed to get graphical instance");
+            }
+            recordBootPhase("graphical loaded");
+            graphical->init(800, 600, "Arcade");
+            if (!graphical->isOpen())
+            {
+                throw std::runtime_error("Graphical library failed to open window");
+            }
+            recordBootPhase("window open");
+
+            if (const char *socketPath = std::getenv("ARCADE_SPECTATOR"))
+            {
+                try
                 {
-                    throw std::runtime_error("Failed to get graphical instance");
+                    _spectator = std::make_unique<SpectatorGraphical>(socketPath, 800, 600);
+                    std::cout << "Serving spectators on " << socketPath << std::endl;
                 }
-                graphical->init(800, 600, "Arcade");
-                if (!graphical->isOpen())
+                catch (const std::exception &e)
                 {
-                    throw std::runtime_error("Graphical library failed to open window");
+                    std::cerr << "Spectator stream disabled: " << e.what() << std::endl;
                 }
             }
         }
@@ -89,10 +194,126 @@ namespace arcade
             stop();
             return;
         }
+        waitForLibraries();
+    }
+
+    void Core::record(const std::string &path, uint64_t seed)
+    {
+        _inputFile.open(path, std::ios::binary | std::ios::trunc);
+        if (!_inputFile.is_open())
+        {
+            throw std::runtime_error("Cannot write input log: " + path);
+        }
+        _inputRecorder = std::make_unique<InputLogWriter>(seed);
+        const std::vector<uint8_t> &header = _inputRecorder->data();
+        _inputFile.write(reinterpret_cast<const char *>(header.data()), header.size());
+        _inputRecorder->drain();
+    }
+
+    void Core::replay(std::vector<uint8_t> log, bool maxSpeed)
+    {
+        _replayData = std::move(log);
+        _replay = std::make_unique<InputLogReader>(_replayData.data(), _replayData.size());
+        _maxSpeed = maxSpeed;
+    }
+
+    // A recorded tick keeps its duration in whole microseconds, so the
+    // replay hands the games the very same float. During a replay only
+    // QUIT is taken from the backend, and the end of the log quits.
+    EventType Core::nextEvent(IGraphical &graphical, float *deltaTime)
+    {
+        EventType event = graphical.getEvent();
+        if (_replay)
+        {
+            uint32_t micros = 0;
+            if (event == EventType::QUIT || !_replay->next(micros, event))
+            {
+                return EventType::QUIT;
+            }
+            _inputEvents++;
+            if (deltaTime)
+            {
+                *deltaTime = micros / 1e6f;
+                _inputTicks++;
+                _replayClock += std::chrono::microseconds(micros);
+                if (!_maxSpeed)
+                {
+                    std::this_thread::sleep_until(_replayStart + _replayClock);
+                }
+            }
+            return event;
+        }
+        if (_inputRecorder)
+        {
+            uint32_t micros = 0;
+            if (deltaTime)
+            {
+                micros = static_cast<uint32_t>(std::lround(*deltaTime * 1e6f));
+                *deltaTime = micros / 1e6f;
+                _inputTicks++;
+            }
+            _inputRecorder->event(micros, event);
+            _inputEvents++;
+            const std::vector<uint8_t> &data = _inputRecorder->data();
+            _inputFile.write(reinterpret_cast<const char *>(data.data()), data.size());
+            _inputRecorder->drain();
+        }
+        return event;
+    }
+
+    // FNV-1a of the game's snapshot: a replay that ends on the recorded
+    // session's checksum went through the same states.
+    uint64_t Core::checksum(const IGame &game)
+    {
+        std::vector<uint8_t> state;
+        uint64_t hash = 14695981039346656037ull;
+        game.snapshot(state);
+        for (uint8_t byte : state)
+        {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Waits between polls, except in a maximum speed replay.
+    void Core::idle(std::chrono::milliseconds duration)
+    {
+        if (!_maxSpeed)
+        {
+            std::this_thread::sleep_for(duration);
+        }
+    }
+
+    void Core::reportInput()
+    {
+        if (_inputRecorder)
+        {
+            _inputFile.flush();
+            std::cerr << "Input log: " << _inputTicks << " ticks, " << _inputEvents << " events, "
+                      << _inputFile.tellp() << " bytes, final state " << std::hex << _finalState << std::dec
+                      << std::endl;
+            _inputFile.close();
+            _inputRecorder.reset();
+        }
+        if (_replay)
+        {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _replayStart).count();
+            std::cerr << "Replay: " << _inputTicks << " ticks (" << (_replayClock.count() / 1e6) << " s recorded) in "
+                      << seconds << " s, " << (seconds > 0 ? _inputTicks / seconds : 0) << " ticks/s"
+                      << ", final state " << std::hex << _finalState << std::dec
+                      << (_replay->atEnd() ? "" : ", stopped before the end of the log") << std::endl;
+            _replay.reset();
+        }
     }
 
     void Core::stop()
     {
+        if (_bootWorker.valid())
+        {
+            _bootWorker.wait();
+        }
+        _preparedGame.reset();
+
         if (_gameLoader)
         {
             try
@@ -100,6 +321,10 @@ namespace arcade
                 auto game = _gameLoader->getInstance();
                 if (game)
                 {
+                    if (_inputRecorder || _replay)
+                    {
+                        _finalState = checksum(*game);
+                    }
                     game->stop();
                 }
             }
@@ -134,10 +359,44 @@ namespace arcade
             }
             _graphicalLoader.reset();
         }
+        _spectator.reset();
+        reportBoot();
+        _rewind.report(std::cerr);
+        reportInput();
+    }
+
+    // With spectators enabled, hands out the tee in front of graphical. The
+    // returned pointer shares graphical's ownership, like the plain one.
+    std::shared_ptr<IGraphical> Core::spectate(const std::shared_ptr<IGraphical> &graphical)
+    {
+        if (!_spectator || !graphical)
+            return graphical;
+        _spectator->setTarget(graphical.get());
+        return std::shared_ptr<IGraphical>(graphical, _spectator.get());
     }
 
     void Core::switchGraphical(int direction)
     {
+        // A replay stays on the backend it was started with, and leaves the
+        // game as the recorded switch did: carried over through its
+        // snapshot, or unloaded from the menu.
+        if (_replay)
+        {
+            if (_gameLoader)
+            {
+                auto game = _gameLoader->getInstance();
+                if (_state != GameState::MENU && game && game->getState() != GameState::MENU)
+                {
+                    game->setState(_state);
+                }
+                else
+                {
+                    _gameLoader.reset();
+                    _state = GameState::MENU;
+                }
+            }
+            return;
+        }
         if (_graphicalLibs.empty())
         {
             std::cerr << "No graphical libraries available" << std::endl;
@@ -154,6 +413,7 @@ namespace arcade
         size_t oldIndex = _currentGraphicalIndex;
         GameState previousState = _state;
         std::unique_ptr<DLLoader<IGame>> gameLoaderBackup;
+        std::vector<uint8_t> gameSnapshot;
 
         if (_gameLoader)
         {
@@ -163,6 +423,7 @@ namespace arcade
                 if (game && game->getState() != GameState::MENU)
                 {
                     updateHighScores(game->getName(), game->getScore());
+                    game->snapshot(gameSnapshot);
                     game->stop();
                     gameLoaderBackup = std::move(_gameLoader);
                 }
@@ -238,6 +499,10 @@ namespace arcade
             }
 
             _currentGraphicalIndex = newIndex;
+            if (_spectator)
+            {
+                _spectator->setTarget(newGraphical.get());
+            }
             std::cout << "Graphical library switched successfully" << std::endl;
 
             newGraphical->clear();
@@ -259,7 +524,12 @@ namespace arcade
                     auto game = _gameLoader->getInstance();
                     if (game)
                     {
-                        game->init();
+                        // The game carries on where it was; init() only
+                        // if it cannot take its own snapshot back.
+                        if (!game->restore(gameSnapshot))
+                        {
+                            startGame(*game);
+                        }
                         game->setState(previousState);
                         _state = previousState;
                     }
@@ -368,7 +638,7 @@ namespace arcade
             }
 
             std::cout << "Initializing game..." << std::endl;
-            game->init();
+            startGame(*game);
             game->setState(GameState::PLAYING);
             _state = GameState::PLAYING;
             std::cout << "Game switched successfully" << std::endl;
@@ -380,43 +650,96 @@ namespace arcade
         }
     }
 
-    void Core::showMenu()
+    void Core::startGame(IGame &game)
     {
-        if (!_graphicalLoader)
-            return;
-
-        auto graphical = _graphicalLoader->getInstance();
-        if (!graphical)
-            return;
+        game.init();
+        game.snapshot(_startSnapshot);
+        clearRewind();
+    }
 
-        graphical->clear();
+    // Back to the snapshot taken when the game started, which replays the
+    // same start (seed included); a game that refuses it restarts itself.
+    void Core::restartGame(IGame &game)
+    {
+        if (!game.restore(_startSnapshot))
+        {
+            game.restart();
+            game.snapshot(_startSnapshot);
+        }
+        clearRewind();
+    }
 
-        graphical->drawText(Text("ARCADE", Position(350, 50), Color(255, 255, 0), 48));
+    void Core::clearRewind()
+    {
+        _rewind.clear();
+        _captureTimer = 0;
+        _rewindBack = 0;
+        _rewindHold = 0;
+    }
 
-        graphical->drawText(Text("Graphical Libraries (Left/Right to switch):", Position(100, 150), Color(255, 255, 255), 18));
-        for (size_t i = 0; i < _graphicalLibs.size(); ++i) {
-            std::string name = std::filesystem::path(_graphicalLibs[i]).filename().string();
-            Color color(255, 255, 255);
-            if (i == _currentGraphicalIndex) {
-                color = Color(0, 255, 0);
+    // Each REWIND event (a key repeat while the key is held) steps back
+    // REWIND_STEP captures and restores that tick. The game then stays on
+    // it, without updates, until another event or REWIND_HOLD seconds
+    // without one, when play resumes from there and the captures after it
+    // are forgotten. Returns true while the game is held.
+    bool Core::rewind(IGame &game, EventType event, float deltaTime)
+    {
+        if (event == EventType::REWIND)
+        {
+            if (_rewind.size() > 0)
+            {
+                size_t back = std::min(_rewindBack + REWIND_STEP, _rewind.size() - 1);
+                if (_rewind.seek(back, _rewindState) && game.restore(_rewindState))
+                {
+                    _rewindBack = back;
+                }
             }
-            graphical->drawText(Text(name, Position(100 + i * 250, 200), color, 16));
+            _rewindHold = REWIND_HOLD;
+            return true;
         }
-        graphical->drawText(Text("Games (Up/Down to switch):", Position(100, 300), Color(255, 255, 255), 18));
-        for (size_t i = 0; i < _gameLibs.size(); ++i) {
-            std::string name = std::filesystem::path(_gameLibs[i]).filename().string();
-            Color color = (i == _currentGameIndex) ? Color(0, 255, 0) : Color(255, 255, 255);
-            graphical->drawText(Text(name, Position(100, 350 + i * 50), color, 16));
+        if (_rewindHold <= 0)
+        {
+            return false;
         }
-        graphical->drawText(Text("Instructions:", Position(100, 500), Color(255, 255, 255), 18));
-        graphical->drawText(Text("Use Arrow Keys to navigate", Position(100, 530), Color(255, 255, 255), 16));
-        graphical->drawText(Text("Press ENTER to start the selected game", Position(100, 560), Color(255, 255, 255), 16));
-        graphical->drawText(Text("Press ESC to quit", Position(100, 590), Color(255, 255, 255), 16));
-        if (!_highScores.empty()) {
-            displayHighScores(*graphical);
+        _rewindHold -= deltaTime;
+        if (event == EventType::NONE && _rewindHold > 0)
+        {
+            return true;
+        }
+        _rewind.drop(_rewindBack);
+        _rewindBack = 0;
+        _rewindHold = 0;
+        _captureTimer = 0;
+        return false;
+    }
+
+    // Captures the game CAPTURE_RATE times per second of play.
+    void Core::captureRewind(IGame &game, float deltaTime)
+    {
+        if (game.getState() != GameState::PLAYING)
+        {
+            return;
+        }
+        _captureTimer += deltaTime;
+        if (_captureTimer >= 1.0f / Rewind::CAPTURE_RATE)
+        {
+            _captureTimer = std::fmod(_captureTimer, 1.0f / Rewind::CAPTURE_RATE);
+            _rewind.capture(game);
         }
-        graphical->display();
-        EventType event = graphical->getEvent();
+    }
+
+    void Core::showMenu()
+    {
+        if (!_graphicalLoader)
+            return;
+
+        auto graphical = spectate(_graphicalLoader->getInstance());
+        if (!graphical)
+            return;
+
+        if (!_maxSpeed)
+            drawMenu(*graphical);
+        EventType event = nextEvent(*graphical);
         switch (event) {
         case EventType::MOVE_UP:
             if (!_gameLibs.empty()) {
@@ -430,10 +753,12 @@ namespace arcade
             break;
         case EventType::MOVE_LEFT:
             std::cout << "Switching to previous graphical library." << std::endl;
+            graphical.reset();
             switchGraphical(-1);
             break;
         case EventType::MOVE_RIGHT:
             std::cout << "Switching to next graphical library." << std::endl;
+            graphical.reset();
             switchGraphical(1);
             break;
         case EventType::ACTION:
@@ -443,12 +768,25 @@ namespace arcade
                     if (_gameLoader && _gameLibs[_currentGameIndex] == _gameLoader->getPath())
                     {
                         auto game = _gameLoader->getInstance();
-                        game->restart();
+                        restartGame(*game);
                         game->setState(GameState::PLAYING);
                         _state = GameState::PLAYING;
                     }
                     else
                     {
+                        if (_bootWorker.valid())
+                        {
+                            _bootWorker.wait();
+                        }
+                        if (_preparedGame && _preparedGame->getPath() == _gameLibs[_currentGameIndex])
+                        {
+                            _gameLoader = std::move(_preparedGame);
+                            _startSnapshot = std::move(_preparedStart);
+                            clearRewind();
+                            _gameLoader->getInstance()->setState(GameState::PLAYING);
+                            _state = GameState::PLAYING;
+                            return;
+                        }
                         std::cout << "Loading game: " << _gameLibs[_currentGameIndex] << std::endl;
                         _gameLoader = std::make_unique<DLLoader<IGame>>(_gameLibs[_currentGameIndex]);
                         auto game = _gameLoader->getInstance();
@@ -458,7 +796,7 @@ namespace arcade
                             return;
                         }
                         std::cout << "Game loaded successfully" << std::endl;
-                        game->init();
+                        startGame(*game);
                         game->setState(GameState::PLAYING);
                         _state = GameState::PLAYING;
                     }
@@ -478,25 +816,62 @@ namespace arcade
         }
     }
 
+    void Core::drawMenu(IGraphical &graphical)
+    {
+        graphical.clear();
+
+        graphical.drawText(Text("ARCADE", Position(350, 50), Color(255, 255, 0), 48));
+
+        graphical.drawText(Text("Graphical Libraries (Left/Right to switch):", Position(100, 150), Color(255, 255, 255), 18));
+        for (size_t i = 0; i < _graphicalLibs.size(); ++i) {
+            std::string name = std::filesystem::path(_graphicalLibs[i]).filename().string();
+            Color color(255, 255, 255);
+            if (i == _currentGraphicalIndex) {
+                color = Color(0, 255, 0);
+            }
+            graphical.drawText(Text(name, Position(100 + i * 250, 200), color, 16));
+        }
+        graphical.drawText(Text("Games (Up/Down to switch):", Position(100, 300), Color(255, 255, 255), 18));
+        for (size_t i = 0; i < _gameLibs.size(); ++i) {
+            std::string name = std::filesystem::path(_gameLibs[i]).filename().string();
+            Color color = (i == _currentGameIndex) ? Color(0, 255, 0) : Color(255, 255, 255);
+            graphical.drawText(Text(name, Position(100, 350 + i * 50), color, 16));
+        }
+        graphical.drawText(Text("Instructions:", Position(100, 500), Color(255, 255, 255), 18));
+        graphical.drawText(Text("Use Arrow Keys to navigate", Position(100, 530), Color(255, 255, 255), 16));
+        graphical.drawText(Text("Press ENTER to start the selected game", Position(100, 560), Color(255, 255, 255), 16));
+        graphical.drawText(Text("Press ESC to quit", Position(100, 590), Color(255, 255, 255), 16));
+        if (!_highScores.empty()) {
+            displayHighScores(graphical);
+        }
+        graphical.display();
+    }
+
     void Core::run()
     {
         if (!_graphicalLoader) {
             std::cerr << "No graphical library loaded" << std::endl;
             return;
         }
-        auto graphical = _graphicalLoader->getInstance();
-        if (!graphical) {
+        if (!_graphicalLoader->getInstance()) {
             std::cerr << "Failed to get graphical instance" << std::endl;
             return;
         }
         _lastUpdateTime = std::chrono::steady_clock::now();
+        _replayStart = _lastUpdateTime;
         _state = GameState::MENU;
-        while (graphical->isOpen()) {
+        while (_graphicalLoader) {
+            // Taken anew every tick and dropped before anything that may
+            // switch backends: the old one is closed and unloaded there.
+            auto graphical = spectate(_graphicalLoader->getInstance());
+            if (!graphical || !graphical->isOpen()) {
+                break;
+            }
             auto currentTime = std::chrono::steady_clock::now();
             float deltaTime = std::chrono::duration<float>(currentTime - _lastUpdateTime).count();
             deltaTime = std::min(deltaTime, 1.0f / 30.0f);
             _lastUpdateTime = currentTime;
-            EventType event = graphical->getEvent();
+            EventType event = nextEvent(*graphical, &deltaTime);
             if (event == EventType::QUIT) {
                 if (graphical) {
                     graphical->close();
@@ -505,21 +880,23 @@ namespace arcade
             }
             if (event == EventType::NEXT_LIB) {
                 std::cout << "Switching to next graphical library via hotkey." << std::endl;
+                graphical.reset();
                 switchGraphical(1);
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                idle(std::chrono::milliseconds(200));
                 continue;
             } else if (event == EventType::PREV_LIB) {
                 std::cout << "Switching to previous graphical library via hotkey." << std::endl;
+                graphical.reset();
                 switchGraphical(-1);
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                idle(std::chrono::milliseconds(200));
                 continue;
             } else if (event == EventType::NEXT_GAME) {
                 switchGame(1);
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                idle(std::chrono::milliseconds(200));
                 continue;
             } else if (event == EventType::PREV_GAME) {
                 switchGame(-1);
-                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                idle(std::chrono::milliseconds(200));
                 continue;
             } else if (event == EventType::MENU) {
                 _state = GameState::MENU;
@@ -537,52 +914,75 @@ namespace arcade
                 continue;
             }
             if (_state == GameState::MENU) {
+                graphical.reset();
                 showMenu();
+                if (!_firstFrameShown) {
+                    _firstFrameShown = true;
+                    recordBootPhase("first frame");
+                    // Phases the worker records later are reported by stop().
+                    reportBoot();
+                }
             } else {
                 if (_gameLoader) {
                     auto game = _gameLoader->getInstance();
                     if (game) {
-                        if (event == EventType::PAUSE) {
-                            GameState currentState = game->getState();
-                            game->setState(currentState == GameState::PLAYING ? GameState::PAUSED : GameState::PLAYING);
-                        } else{
-                            game->handleEvent(event);
+                        if (!rewind(*game, event, deltaTime)) {
+                            if (event == EventType::PAUSE) {
+                                GameState currentState = game->getState();
+                                game->setState(currentState == GameState::PLAYING ? GameState::PAUSED : GameState::PLAYING);
+                            } else{
+                                game->handleEvent(event);
+                            }
+                            game->update(deltaTime);
+                            captureRewind(*game, deltaTime);
                         }
-                        game->update(deltaTime);
                         if (!graphical->isOpen()) {
                             break;
                         }
-                        game->render(*graphical);
-                        graphical->drawText(Text("Score: " + std::to_string(game->getScore()),
-                                                 Position(50, 50), Color(255, 255, 0), 16));
+                        if (!_maxSpeed) {
+                            game->render(*graphical);
+                            graphical->drawText(Text("Score: " + std::to_string(game->getScore()),
+                                                     Position(50, 50), Color(255, 255, 0), 16));
+                        }
 
                         if (game->getState() == GameState::GAME_OVER || game->getState() == GameState::WIN)
                         {
-                            graphical->drawText(Text(game->getState() == GameState::GAME_OVER ? "GAME OVER" : "YOU WIN",
-                                                     Position(350, 250), Color(255, 0, 0), 32));
-                            graphical->drawText(Text("Final Score: " + std::to_string(game->getScore()),
-                                                     Position(350, 300), Color(255, 255, 255), 24));
-                            graphical->drawText(Text("Press ENTER to return to menu",
-                                                     Position(350, 350), Color(255, 255, 255), 18));
-                            graphical->drawText(Text("Press R to restart game",
-                                                     Position(350, 380), Color(255, 255, 255), 18));
-                            graphical->display();
-
-                            updateHighScores(game->getName(), game->getScore());
+                            if (!_maxSpeed) {
+                                graphical->drawText(Text(game->getState() == GameState::GAME_OVER ? "GAME OVER" : "YOU WIN",
+                                                         Position(350, 250), Color(255, 0, 0), 32));
+                                graphical->drawText(Text("Final Score: " + std::to_string(game->getScore()),
+                                                         Position(350, 300), Color(255, 255, 255), 24));
+                                graphical->drawText(Text("Press ENTER to return to menu",
+                                                         Position(350, 350), Color(255, 255, 255), 18));
+                                graphical->drawText(Text("Press R to restart game",
+                                                         Position(350, 380), Color(255, 255, 255), 18));
+                                graphical->display();
+                            }
+
+                            // A replay's scores were already counted when
+                            // it was recorded.
+                            if (!_replay) {
+                                updateHighScores(game->getName(), game->getScore());
+                            }
 
                             bool waitingForInput = true;
                             while (waitingForInput && graphical->isOpen()){
-                                EventType endEvent = graphical->getEvent();
+                                EventType endEvent = nextEvent(*graphical);
                                 if (endEvent == EventType::ACTION || endEvent == EventType::MENU){
                                     _state = GameState::MENU;
                                     waitingForInput = false;
                                 }
                                 else if (endEvent == EventType::QUIT) {
                                     return;
+                                } else if (endEvent == EventType::REWIND) {
+                                    // Back to before the crash, held there
+                                    // like any other rewind.
+                                    rewind(*game, endEvent, 0.0f);
+                                    waitingForInput = game->getState() != GameState::PLAYING;
                                 } else if (endEvent == EventType::PAUSE){
                                     try
                                     {
-                                        game->restart();
+                                        restartGame(*game);
                                         game->setState(GameState::PLAYING);
                                         waitingForInput = false;
                                     }
@@ -591,7 +991,7 @@ namespace arcade
                                         std::cerr << "Error restarting game: " << e.what() << std::endl;
                                     }
                                 }
-                                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                idle(std::chrono::milliseconds(50));
                             }
                         }
                     } else {
@@ -603,7 +1003,7 @@ namespace arcade
                     _state = GameState::MENU;
                 }
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            idle(std::chrono::milliseconds(5));
         }
     }
 
@@ -2,18 +2,29 @@
 #define CORE_HPP_
 
 #include "DLLoader.hpp"
+#include "Rewind.hpp"
+#include "Spectator.hpp"
 #include "../interfaces/IGraphical.hpp"
 #include "../interfaces/IGame.hpp"
+#include "../interfaces/InputLog.hpp"
 #include <string>
 #include <vector>
 #include <memory>
 #include <chrono>
 #include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
 
 namespace arcade {
 
 class Core {
 private:
+    // Captures stepped back per REWIND event, and how long the game stays
+    // on the rewound tick waiting for the next one.
+    static constexpr size_t REWIND_STEP = 2;
+    static constexpr float REWIND_HOLD = 0.25f;
+
     std::unique_ptr<DLLoader<IGraphical>> _graphicalLoader;
     std::vector<std::shared_ptr<IGraphical>> _previousGraphicals;
     std::unique_ptr<DLLoader<IGame>> _gameLoader;
@@ -26,10 +37,64 @@ private:
     std::vector<std::pair<std::string, int>> _highScores;
     std::shared_ptr<IGraphical> _currentGraphical;
     std::shared_ptr<IGame> _currentGame;
+    std::string _initialGraphical;
+    std::string _initialGame;
+    // Boot work that does not need the window runs on a worker while the
+    // graphical library opens it: _librariesReady resolves once ./lib has
+    // been scanned, _bootWorker once the selected game is loaded and its map
+    // parsed into _preparedGame, with its start snapshot in _preparedStart.
+    std::future<void> _librariesReady;
+    std::future<void> _bootWorker;
+    std::unique_ptr<DLLoader<IGame>> _preparedGame;
+    std::vector<uint8_t> _preparedStart;
+    // Snapshot of the current game right after its init(): restarting
+    // restores it instead of re-running init() and reloading the map.
+    std::vector<uint8_t> _startSnapshot;
+    // Recent ticks of the current game. While rewinding, the game is held
+    // _rewindBack captures back for _rewindHold more seconds.
+    Rewind _rewind;
+    float _captureTimer;
+    size_t _rewindBack;
+    float _rewindHold;
+    std::vector<uint8_t> _rewindState;
+    std::chrono::steady_clock::time_point _bootStart;
+    std::vector<std::pair<std::string, double>> _bootPhases;
+    std::mutex _bootMutex;
+    bool _firstFrameShown;
+    std::unique_ptr<SpectatorGraphical> _spectator;
+    // Every event Core polls goes through nextEvent(), which appends it to
+    // _inputRecorder when recording, or takes it from _replay instead.
+    // _replayClock is the recorded time played so far; a real time replay
+    // keeps to it, a _maxSpeed one neither waits nor renders.
+    std::ofstream _inputFile;
+    std::unique_ptr<InputLogWriter> _inputRecorder;
+    std::vector<uint8_t> _replayData;
+    std::unique_ptr<InputLogReader> _replay;
+    bool _maxSpeed;
+    size_t _inputTicks;
+    size_t _inputEvents;
+    std::chrono::microseconds _replayClock;
+    std::chrono::steady_clock::time_point _replayStart;
+    uint64_t _finalState;
     void loadLibraries();
+    void bootWorker(std::promise<void> librariesReady);
+    void waitForLibraries();
+    void recordBootPhase(const std::string &phase);
+    void reportBoot();
+    std::shared_ptr<IGraphical> spectate(const std::shared_ptr<IGraphical> &graphical);
     void switchGraphical(int direction);
     void switchGame(int direction);
+    void startGame(IGame &game);
+    void restartGame(IGame &game);
+    void clearRewind();
+    bool rewind(IGame &game, EventType event, float deltaTime);
+    void captureRewind(IGame &game, float deltaTime);
+    EventType nextEvent(IGraphical &graphical, float *deltaTime = nullptr);
+    void idle(std::chrono::milliseconds duration);
+    static uint64_t checksum(const IGame &game);
+    void reportInput();
     void showMenu();
+    void drawMenu(IGraphical &graphical);
     void updateHighScores(const std::string &gameName, int score);
     void displayHighScores(IGraphical &graphical);
 
@@ -37,6 +102,11 @@ public:
     Core(const std::string &initialGraphical, const std::string &initialGame);
     ~Core();
     void init();
+    // Records this session's input to path, as played with seed.
+    void record(const std::string &path, uint64_t seed);
+    // Plays back an input log instead of the backend's events; the games
+    // must already be seeded with its seed.
+    void replay(std::vector<uint8_t> log, bool maxSpeed);
     void run();
     void stop();
 };
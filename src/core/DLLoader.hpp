@@ -21,12 +21,9 @@ public:
     }
 
     ~DLLoader() {
-        if (_instance) {
-            auto destroyer = getSymbol<destroyer_t>("destroy");
-            if (destroyer) {
-                destroyer(_instance.get());
-            }
-        }
+        // The shared_ptr deleter calls destroy; it must run while the
+        // library is still mapped, and only once.
+        _instance.reset();
         if (_handle) {
             dlclose(_handle);
         }
@@ -0,0 +1,223 @@
+#include "Rewind.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace arcade
+{
+
+    namespace
+    {
+
+        void putVarint(std::vector<uint8_t> &out, size_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        size_t getVarint(const uint8_t *&data, const uint8_t *end)
+        {
+            size_t value = 0;
+            int shift = 0;
+            while (data < end)
+            {
+                uint8_t byte = *data++;
+                value |= static_cast<size_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+                shift += 7;
+            }
+            return value;
+        }
+
+    }
+
+    Rewind::Rewind()
+        : _entries(MAX_CAPTURES), _first(0), _count(0), _bytes(0), _sinceKeyframe(0), _captures(0),
+          _keyframes(0), _capturedBytes(0), _peakBytes(0), _captureSeconds(0)
+    {
+    }
+
+    void Rewind::clear()
+    {
+        _first = 0;
+        _count = 0;
+        _bytes = 0;
+        _sinceKeyframe = 0;
+        _previous.clear();
+    }
+
+    void Rewind::capture(const IGame &game)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        game.snapshot(_snapshot);
+        if (_count == _entries.size())
+        {
+            dropOldest();
+        }
+        Entry &entry = at(_count);
+        entry.keyframe = _count == 0 || _sinceKeyframe + 1 >= KEYFRAME_INTERVAL || _snapshot.size() != _previous.size();
+        if (entry.keyframe)
+        {
+            entry.data = _snapshot;
+            _sinceKeyframe = 0;
+            _keyframes++;
+        }
+        else
+        {
+            encode(_previous, _snapshot, entry.data);
+            _sinceKeyframe++;
+        }
+        _count++;
+        _bytes += entry.data.size();
+        _previous.swap(_snapshot);
+        while (_bytes > MAX_BYTES && _count > 1)
+        {
+            dropOldest();
+        }
+
+        _captures++;
+        _capturedBytes += entry.data.size();
+        _peakBytes = std::max(_peakBytes, _bytes);
+        _captureSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    size_t Rewind::size() const
+    {
+        return _count;
+    }
+
+    bool Rewind::seek(size_t back, std::vector<uint8_t> &out) const
+    {
+        if (back >= size())
+        {
+            return false;
+        }
+        size_t target = _count - 1 - back;
+        size_t keyframe = target;
+        while (!at(keyframe).keyframe)
+        {
+            keyframe--;
+        }
+        out = at(keyframe).data;
+        for (size_t index = keyframe + 1; index <= target; index++)
+        {
+            apply(at(index).data, out);
+        }
+        return true;
+    }
+
+    void Rewind::drop(size_t back)
+    {
+        back = std::min(back, _count);
+        for (size_t i = 0; i < back; i++)
+        {
+            _count--;
+            _bytes -= at(_count).data.size();
+        }
+        _sinceKeyframe = 0;
+        if (!seek(0, _previous))
+        {
+            clear();
+            return;
+        }
+        for (size_t index = _count - 1; !at(index).keyframe; index--)
+        {
+            _sinceKeyframe++;
+        }
+    }
+
+    // Drops the oldest capture, and the deltas that needed it, so the ring
+    // always starts with a keyframe.
+    void Rewind::dropOldest()
+    {
+        do
+        {
+            _bytes -= at(0).data.size();
+            _first = (_first + 1) % _entries.size();
+            _count--;
+        } while (_count > 0 && !at(0).keyframe);
+    }
+
+    // Runs of equal bytes are found a word at a time, which keeps a
+    // mostly unchanged snapshot well under a microsecond.
+    void Rewind::encode(const std::vector<uint8_t> &previous, const std::vector<uint8_t> &current,
+                        std::vector<uint8_t> &out)
+    {
+        const uint8_t *a = previous.data();
+        const uint8_t *b = current.data();
+        size_t size = current.size();
+        size_t offset = 0;
+
+        out.clear();
+        while (offset < size)
+        {
+            size_t same = offset;
+            while (same + 8 <= size && std::memcmp(a + same, b + same, 8) == 0)
+            {
+                same += 8;
+            }
+            while (same < size && a[same] == b[same])
+            {
+                same++;
+            }
+            if (same == size)
+            {
+                break;
+            }
+            size_t changed = same;
+            while (changed < size && a[changed] != b[changed])
+            {
+                changed++;
+            }
+            putVarint(out, same - offset);
+            putVarint(out, changed - same);
+            for (size_t i = same; i < changed; i++)
+            {
+                out.push_back(a[i] ^ b[i]);
+            }
+            offset = changed;
+        }
+    }
+
+    void Rewind::apply(const std::vector<uint8_t> &delta, std::vector<uint8_t> &state)
+    {
+        const uint8_t *data = delta.data();
+        const uint8_t *end = data + delta.size();
+        size_t offset = 0;
+
+        while (data < end)
+        {
+            offset += getVarint(data, end);
+            size_t changed = getVarint(data, end);
+            for (size_t i = 0; i < changed && data < end && offset < state.size(); i++)
+            {
+                state[offset++] ^= *data++;
+            }
+        }
+    }
+
+    void Rewind::report(std::ostream &out)
+    {
+        if (_captures == 0)
+        {
+            return;
+        }
+        out << "Rewind: " << _captures << " captures at " << (_captureSeconds / _captures * 1e6) << " us, "
+            << (_capturedBytes / _captures) << " bytes average, " << _keyframes << " keyframes, peak "
+            << (_peakBytes / 1024) << " KiB" << std::endl;
+        _captures = 0;
+        _keyframes = 0;
+        _capturedBytes = 0;
+        _peakBytes = 0;
+        _captureSeconds = 0;
+    }
+
+}
@@ -0,0 +1,81 @@
+#ifndef REWIND_HPP_
+#define REWIND_HPP_
+
+#include "../interfaces/IGame.hpp"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace arcade {
+
+// The last few seconds of a game, for rewinding. Every capture is an
+// IGame snapshot, stored in a ring either whole (a keyframe, every
+// KEYFRAME_INTERVAL captures or when the snapshot changes size) or as its
+// XOR with the previous capture, run-length encoded: alternating varint
+// counts of unchanged bytes and of changed bytes, the latter followed by
+// the XORed bytes. A tick that moves one snake or a few ghosts is then a
+// few dozen bytes.
+//
+// Seeking rebuilds a capture from the keyframe before it, so it applies at
+// most KEYFRAME_INTERVAL - 1 deltas. The oldest captures are dropped when
+// the ring holds MAX_CAPTURES or exceeds MAX_BYTES, taking the deltas that
+// depend on them along. Entries keep their storage when overwritten, so a
+// full ring captures without allocating.
+class Rewind {
+public:
+    // Ten seconds at CAPTURE_RATE.
+    static constexpr size_t MAX_CAPTURES = 600;
+    static constexpr size_t KEYFRAME_INTERVAL = 60;
+    static constexpr size_t MAX_BYTES = 4 << 20;
+    // Captures per second of play.
+    static constexpr int CAPTURE_RATE = 60;
+
+    Rewind();
+
+    void clear();
+    // Snapshots game and appends it as the newest capture.
+    void capture(const IGame &game);
+    // Captures that seek() can reach, the newest included.
+    size_t size() const;
+    // Rebuilds the capture back steps before the newest into out; false
+    // when it is no longer held.
+    bool seek(size_t back, std::vector<uint8_t> &out) const;
+    // Forgets the back newest captures: after a rewind, play resumes from
+    // the one seek(back) returned.
+    void drop(size_t back);
+
+    // Prints the capture cost and memory use, then starts counting anew.
+    void report(std::ostream &out);
+
+private:
+    struct Entry {
+        bool keyframe;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Entry> _entries;
+    size_t _first;
+    size_t _count;
+    size_t _bytes;
+    size_t _sinceKeyframe;
+    // The newest capture whole, which the next one is diffed against.
+    std::vector<uint8_t> _previous;
+    std::vector<uint8_t> _snapshot;
+
+    size_t _captures;
+    size_t _keyframes;
+    size_t _capturedBytes;
+    size_t _peakBytes;
+    double _captureSeconds;
+
+    Entry &at(size_t index) { return _entries[(_first + index) % _entries.size()]; }
+    const Entry &at(size_t index) const { return _entries[(_first + index) % _entries.size()]; }
+    void dropOldest();
+    static void encode(const std::vector<uint8_t> &previous, const std::vector<uint8_t> &current,
+                       std::vector<uint8_t> &out);
+    static void apply(const std::vector<uint8_t> &delta, std::vector<uint8_t> &state);
+};
+
+}
+
+#endif
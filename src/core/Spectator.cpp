@@ -0,0 +1,296 @@
+#include "Spectator.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace arcade
+{
+
+    SpectatorGraphical::SpectatorGraphical(const std::string &socketPath, int width, int height)
+        : _socketPath(socketPath), _listenFd(-1), _width(width), _height(height), _target(nullptr),
+          _frame(false), _frameCount(0), _deltaFrames(0), _deltaBytes(0), _keyframes(0),
+          _keyframeBytes(0), _droppedFrames(0), _peakViewers(0)
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("Spectator socket path too long: " + socketPath);
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+        struct stat info;
+        if (lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        {
+            unlink(socketPath.c_str());
+        }
+
+        _listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (_listenFd < 0)
+        {
+            throw std::runtime_error("Cannot create spectator socket: " + std::string(std::strerror(errno)));
+        }
+        if (bind(_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+            listen(_listenFd, 16) < 0)
+        {
+            std::string error = std::strerror(errno);
+            ::close(_listenFd);
+            throw std::runtime_error("Cannot listen on " + socketPath + ": " + error);
+        }
+    }
+
+    SpectatorGraphical::~SpectatorGraphical()
+    {
+        for (auto &viewer : _viewers)
+        {
+            ::close(viewer.fd);
+        }
+        ::close(_listenFd);
+        unlink(_socketPath.c_str());
+
+        std::cerr << "Spectator: " << _frameCount << " frames, " << _peakViewers << " viewers peak";
+        if (_deltaFrames > 0)
+        {
+            std::cerr << ", " << _deltaFrames << " delta frames at " << (_deltaBytes / _deltaFrames) << " bytes average";
+        }
+        if (_keyframes > 0)
+        {
+            std::cerr << ", " << _keyframes << " keyframes at " << (_keyframeBytes / _keyframes) << " bytes average";
+        }
+        std::cerr << ", " << _droppedFrames << " frames dropped for slow viewers" << std::endl;
+    }
+
+    void SpectatorGraphical::setTarget(IGraphical *target)
+    {
+        _target = target;
+    }
+
+    void SpectatorGraphical::init(int width, int height, const std::string &title)
+    {
+        _target->init(width, height, title);
+    }
+
+    void SpectatorGraphical::close()
+    {
+        _target->close();
+    }
+
+    bool SpectatorGraphical::isOpen() const
+    {
+        return _target && _target->isOpen();
+    }
+
+    void SpectatorGraphical::clear()
+    {
+        _target->clear();
+        _frame.clear();
+    }
+
+    void SpectatorGraphical::display()
+    {
+        _target->display();
+        publish();
+    }
+
+    EventType SpectatorGraphical::getEvent()
+    {
+        return _target->getEvent();
+    }
+
+    void SpectatorGraphical::drawRectangle(const Position &pos, int width, int height, const Color &color)
+    {
+        _target->drawRectangle(pos, width, height, color);
+        _frame.rectangle(pos, width, height, color);
+    }
+
+    void SpectatorGraphical::drawCircle(const Position &pos, int radius, const Color &color)
+    {
+        _target->drawCircle(pos, radius, color);
+        _frame.circle(pos, radius, color);
+    }
+
+    void SpectatorGraphical::drawSprite(const Sprite &sprite)
+    {
+        _target->drawSprite(sprite);
+        _frame.sprite(sprite);
+    }
+
+    void SpectatorGraphical::drawText(const Text &text)
+    {
+        _target->drawText(text);
+        _frame.text(text);
+    }
+
+    void SpectatorGraphical::drawCell(int x, int y, const Color &color)
+    {
+        _target->drawCell(x, y, color);
+        _frame.cell(x, y, color);
+    }
+
+    void SpectatorGraphical::setCellSize(int size)
+    {
+        _target->setCellSize(size);
+        _frame.cellSize(size);
+    }
+
+    std::string SpectatorGraphical::getName() const
+    {
+        return _target->getName();
+    }
+
+    static std::shared_ptr<const std::vector<uint8_t>> frameMessage(const DrawLogWriter &writer)
+    {
+        const std::vector<uint8_t> &data = writer.data();
+        auto message = std::make_shared<std::vector<uint8_t>>();
+        message->reserve(data.size() + 4);
+        uint32_t size = static_cast<uint32_t>(data.size());
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            message->push_back(static_cast<uint8_t>(size >> shift));
+        }
+        message->insert(message->end(), data.begin(), data.end());
+        return message;
+    }
+
+    SpectatorGraphical::Message SpectatorGraphical::hello() const
+    {
+        DrawLogWriter writer;
+        writer.init(_width, _height);
+        return frameMessage(writer);
+    }
+
+    SpectatorGraphical::Message SpectatorGraphical::encode(bool keyframe)
+    {
+        DrawLogWriter writer(false);
+        _encoder.encode(_frame, keyframe, writer);
+        Message message = frameMessage(writer);
+        if (keyframe)
+        {
+            _keyframes++;
+            _keyframeBytes += message->size();
+        }
+        else
+        {
+            _deltaFrames++;
+            _deltaBytes += message->size();
+        }
+        return message;
+    }
+
+    void SpectatorGraphical::acceptViewers()
+    {
+        while (true)
+        {
+            int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                return;
+            }
+            // The header goes out at once, into an empty socket buffer, so
+            // dropping a backlog later can never discard it.
+            _viewers.push_back(Viewer{fd, {}, 0, 0, true});
+            enqueue(_viewers.back(), hello());
+            if (!flush(_viewers.back()))
+            {
+                ::close(fd);
+                _viewers.pop_back();
+                continue;
+            }
+            _peakViewers = std::max(_peakViewers, _viewers.size());
+        }
+    }
+
+    void SpectatorGraphical::publish()
+    {
+        acceptViewers();
+
+        if (!_viewers.empty())
+        {
+            bool periodic = _frameCount % KEYFRAME_INTERVAL == 0;
+            Message delta;
+            Message keyframe;
+            for (auto &viewer : _viewers)
+            {
+                if (viewer.backlog > MAX_VIEWER_BACKLOG)
+                {
+                    // Keep a partially sent message so the stream stays framed.
+                    size_t keep = viewer.sent > 0 ? 1 : 0;
+                    _droppedFrames += viewer.queue.size() - keep;
+                    viewer.queue.resize(keep);
+                    viewer.backlog = keep ? viewer.queue.front()->size() - viewer.sent : 0;
+                    viewer.needsKeyframe = true;
+                }
+                if (periodic || viewer.needsKeyframe)
+                {
+                    if (!keyframe)
+                    {
+                        keyframe = encode(true);
+                    }
+                    enqueue(viewer, keyframe);
+                    viewer.needsKeyframe = false;
+                }
+                else
+                {
+                    if (!delta)
+                    {
+                        delta = encode(false);
+                    }
+                    enqueue(viewer, delta);
+                }
+            }
+
+            for (size_t i = 0; i < _viewers.size();)
+            {
+                if (flush(_viewers[i]))
+                {
+                    i++;
+                    continue;
+                }
+                ::close(_viewers[i].fd);
+                _viewers.erase(_viewers.begin() + i);
+            }
+        }
+
+        _encoder.commit(_frame);
+        _frame.drain();
+        _frameCount++;
+    }
+
+    void SpectatorGraphical::enqueue(Viewer &viewer, const Message &message)
+    {
+        viewer.queue.push_back(message);
+        viewer.backlog += message->size();
+    }
+
+    bool SpectatorGraphical::flush(Viewer &viewer)
+    {
+        while (!viewer.queue.empty())
+        {
+            const std::vector<uint8_t> &message = *viewer.queue.front();
+            ssize_t written = send(viewer.fd, message.data() + viewer.sent, message.size() - viewer.sent,
+                                   MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            viewer.sent += written;
+            viewer.backlog -= written;
+            if (viewer.sent == message.size())
+            {
+                viewer.queue.pop_front();
+                viewer.sent = 0;
+            }
+        }
+        return true;
+    }
+
+}
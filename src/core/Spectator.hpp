@@ -0,0 +1,91 @@
+#ifndef SPECTATOR_HPP_
+#define SPECTATOR_HPP_
+
+#include "../interfaces/IGraphical.hpp"
+#include "../interfaces/DrawLog.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// Sits between Core and the active display library: every call is
+// forwarded, and the draw calls of each frame are also served to viewers
+// connected to a Unix domain socket.
+//
+// Each message on the socket is a 32-bit little-endian length followed by
+// DrawLog bytes. The first message holds the log header and an INIT record,
+// every later one a single frame, delta encoded against the previous frame
+// or, every KEYFRAME_INTERVAL frames and whenever a viewer needs to resync,
+// sent whole. Sockets are non-blocking: a viewer whose backlog exceeds
+// MAX_VIEWER_BACKLOG loses its queued frames and restarts from a keyframe,
+// so a slow viewer never delays the game loop.
+class SpectatorGraphical : public IGraphical {
+public:
+    static constexpr size_t KEYFRAME_INTERVAL = 120;
+    static constexpr size_t MAX_VIEWER_BACKLOG = 1 << 20;
+
+    SpectatorGraphical(const std::string &socketPath, int width, int height);
+    ~SpectatorGraphical() override;
+
+    // Display library the calls are forwarded to; not owned.
+    void setTarget(IGraphical *target);
+
+    void init(int width, int height, const std::string &title) override;
+    void close() override;
+    bool isOpen() const override;
+    void clear() override;
+    void display() override;
+
+    EventType getEvent() override;
+
+    void drawRectangle(const Position &pos, int width, int height, const Color &color) override;
+    void drawCircle(const Position &pos, int radius, const Color &color) override;
+    void drawSprite(const Sprite &sprite) override;
+    void drawText(const Text &text) override;
+
+    void drawCell(int x, int y, const Color &color) override;
+    void setCellSize(int size) override;
+
+    std::string getName() const override;
+
+private:
+    using Message = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Viewer {
+        int fd;
+        std::deque<Message> queue;
+        size_t sent;
+        size_t backlog;
+        bool needsKeyframe;
+    };
+
+    std::string _socketPath;
+    int _listenFd;
+    int _width;
+    int _height;
+    IGraphical *_target;
+    std::vector<Viewer> _viewers;
+    DrawLogWriter _frame;
+    DrawFrameEncoder _encoder;
+    size_t _frameCount;
+    size_t _deltaFrames;
+    size_t _deltaBytes;
+    size_t _keyframes;
+    size_t _keyframeBytes;
+    size_t _droppedFrames;
+    size_t _peakViewers;
+
+    Message hello() const;
+    Message encode(bool keyframe);
+    void acceptViewers();
+    void publish();
+    void enqueue(Viewer &viewer, const Message &message);
+    bool flush(Viewer &viewer);
+};
+
+}
+
+#endif
@@ -6,12 +6,21 @@
 */
 
 #include "Core.hpp"
+#include "../interfaces/InputLog.hpp"
+#include "../interfaces/Random.hpp"
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 
 void displayUsage(const std::string &programName) {
-    std::cout << "USAGE: " << programName << " path_to_graphical_lib" << std::endl;
+    std::cout << "USAGE: " << programName << " path_to_graphical_lib [--seed N] [--record FILE]" << std::endl;
+    std::cout << "       " << programName << " path_to_graphical_lib --replay FILE [--max-speed]" << std::endl;
     std::cout << "       path_to_graphical_lib: Path to a graphical library (.so file)" << std::endl;
+    std::cout << "       --seed N: Seed every game with N, to replay a session" << std::endl;
+    std::cout << "       --record FILE: Write the session's seed and input to FILE" << std::endl;
+    std::cout << "       --replay FILE: Play a recorded session back instead of reading input" << std::endl;
+    std::cout << "       --max-speed: Replay without waiting or rendering" << std::endl;
 }
 
 void displayAvailableLibs() {
@@ -26,11 +35,51 @@ void displayAvailableLibs() {
 bool isGraphicalLibrary(const std::string &path) {
     return path.find("_ncurses.so") != std::string::npos ||
            path.find("_sfml.so") != std::string::npos ||
-           path.find("_sdl2.so") != std::string::npos;
+           path.find("_sdl2.so") != std::string::npos ||
+           path.find("_ansi.so") != std::string::npos ||
+           path.find("_soft.so") != std::string::npos ||
+           path.find("_null.so") != std::string::npos;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
 }
 
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    const char *seedText = nullptr;
+    std::string recordPath;
+    std::string replayPath;
+    bool maxSpeed = false;
+    bool valid = argc >= 2;
+    for (int i = 2; valid && i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--max-speed") {
+            maxSpeed = true;
+        } else if (i + 1 >= argc) {
+            valid = false;
+        } else if (option == "--seed") {
+            seedText = argv[++i];
+        } else if (option == "--record") {
+            recordPath = argv[++i];
+        } else if (option == "--replay") {
+            replayPath = argv[++i];
+        } else {
+            valid = false;
+        }
+    }
+    // A replay brings its own seed and input.
+    if (!replayPath.empty() && (seedText || !recordPath.empty())) {
+        valid = false;
+    }
+    if (maxSpeed && replayPath.empty()) {
+        valid = false;
+    }
+    if (!valid) {
         displayUsage(argv[0]);
         displayAvailableLibs();
         return 84;
@@ -45,12 +94,52 @@ int main(int argc, char **argv) {
         std::cerr << "Error: '" << graphicalLibPath << "' not a graphical library" << std::endl;
         return 84;
     }
+    // Games take their seed from ARCADE_SEED, so it reaches every library
+    // the core loads. A recording needs one to write down even when none
+    // was given, and a replay uses the one it was recorded with.
+    uint64_t seed = 0;
+    std::vector<uint8_t> replayLog;
+    if (seedText) {
+        setenv("ARCADE_SEED", seedText, 1);
+        if (!arcade::Random::seedFromEnvironment(seed)) {
+            std::cerr << "Error: invalid seed: " << seedText << std::endl;
+            return 84;
+        }
+    } else if (!replayPath.empty()) {
+        if (!readFile(replayPath, replayLog)) {
+            std::cerr << "Error: cannot read input log: " << replayPath << std::endl;
+            return 84;
+        }
+        try {
+            seed = arcade::InputLogReader(replayLog.data(), replayLog.size()).getSeed();
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << replayPath << ": " << e.what() << std::endl;
+            return 84;
+        }
+        setenv("ARCADE_SEED", std::to_string(seed).c_str(), 1);
+    } else if (!recordPath.empty()) {
+        // Printed once, before the display takes the terminal, unless it
+        // came from ARCADE_SEED.
+        bool chosen = !arcade::Random::seedFromEnvironment(seed);
+        seed = arcade::Random::sessionSeed();
+        setenv("ARCADE_SEED", std::to_string(seed).c_str(), 1);
+        if (chosen) {
+            std::cerr << "Session seed " << seed << std::endl;
+        }
+    }
     try {
         arcade::Core core(graphicalLibPath, "");
+        if (!recordPath.empty()) {
+            core.record(recordPath, seed);
+        }
+        if (!replayPath.empty()) {
+            core.replay(std::move(replayLog), maxSpeed);
+        }
         core.init();
         core.run();
     } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 84;
     }
     return 0;
-}
\ No newline at end of file
+}
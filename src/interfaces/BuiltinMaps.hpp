@@ -0,0 +1,197 @@
+#ifndef BUILTIN_MAPS_HPP_
+#define BUILTIN_MAPS_HPP_
+
+#include "Grid.hpp"
+#include "MapFile.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace arcade {
+
+// A map whose size is part of its type, built entirely at compile time: the
+// wall and dot layers are constexpr arrays of GridLayer words, so loading
+// one is a copy of the words with loop bounds the compiler knows. Text maps
+// go through parseMap(); a malformed literal fails the build rather than
+// the game.
+template <int W, int H>
+struct StaticMap {
+    static_assert(W > 0 && H > 0, "A map needs at least one cell");
+
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int STRIDE = (W + 63) / 64;
+    static constexpr int MAX_MARKERS = 16;
+
+    std::array<uint64_t, STRIDE * H> walls{};
+    std::array<uint64_t, STRIDE * H> dots{};
+    std::array<int, H> rowLengths{};
+    std::array<char, MAX_MARKERS> markerTiles{};
+    std::array<int, MAX_MARKERS> markerX{};
+    std::array<int, MAX_MARKERS> markerY{};
+    int markerCount = 0;
+
+    constexpr bool isWall(int x, int y) const {
+        return x < 0 || x >= W || y < 0 || y >= H
+            || ((walls[y * STRIDE + x / 64] >> (x % 64)) & 1);
+    }
+    constexpr bool isDot(int x, int y) const {
+        return x >= 0 && x < W && y >= 0 && y < H
+            && ((dots[y * STRIDE + x / 64] >> (x % 64)) & 1);
+    }
+    constexpr void setWall(int x, int y) { walls[y * STRIDE + x / 64] |= uint64_t(1) << (x % 64); }
+    constexpr void setDot(int x, int y) { dots[y * STRIDE + x / 64] |= uint64_t(1) << (x % 64); }
+
+    // Replaces the walls of a layer at least W x H with this map's.
+    void stampWalls(GridLayer &layer) const {
+        layer.assignRows(walls.data(), STRIDE, H);
+    }
+
+    CompiledMap toCompiledMap() const {
+        CompiledMap map;
+        map.width = W;
+        map.height = H;
+        map.rowLengths.assign(rowLengths.begin(), rowLengths.end());
+        map.walls.resize(W, H);
+        map.walls.assignRows(walls.data(), STRIDE, H);
+        map.dots.resize(W, H);
+        map.dots.assignRows(dots.data(), STRIDE, H);
+        map.walls.forEach([&map](int x, int y) {
+            map.wallCells.push_back(Position(x, y));
+        });
+        for (int i = 0; i < markerCount; i++) {
+            map.markers.push_back({markerTiles[i], Position(markerX[i], markerY[i])});
+        }
+        return map;
+    }
+};
+
+// Rows of a '\n'-separated map literal; a trailing newline ends the last row.
+template <size_t N>
+constexpr int mapTextHeight(const char (&text)[N]) {
+    int rows = 0;
+    bool pending = false;
+    for (size_t i = 0; i + 1 < N; i++) {
+        if (text[i] == '\n') {
+            rows++;
+            pending = false;
+        } else {
+            pending = true;
+        }
+    }
+    return rows + (pending ? 1 : 0);
+}
+
+template <size_t N>
+constexpr int mapTextWidth(const char (&text)[N]) {
+    int width = 0;
+    int current = 0;
+    for (size_t i = 0; i + 1 < N; i++) {
+        if (text[i] == '\n') {
+            current = 0;
+        } else if (++current > width) {
+            width = current;
+        }
+    }
+    return width;
+}
+
+// Same tiles as CompiledMap::fromText: '#' wall, '.' dot, ' ' floor and
+// anything else a marker.
+template <int W, int H, size_t N>
+constexpr StaticMap<W, H> parseMap(const char (&text)[N]) {
+    StaticMap<W, H> map{};
+    int x = 0;
+    int y = 0;
+    for (size_t i = 0; i + 1 < N; i++) {
+        char tile = text[i];
+        if (tile == '\n') {
+            map.rowLengths[y] = x;
+            x = 0;
+            y++;
+            continue;
+        }
+        if (x >= W || y >= H) {
+            throw std::logic_error("Map literal larger than its declared size");
+        }
+        if (tile == '#') {
+            map.setWall(x, y);
+        } else if (tile == '.') {
+            map.setDot(x, y);
+        } else if (tile != ' ') {
+            if (map.markerCount == StaticMap<W, H>::MAX_MARKERS) {
+                throw std::logic_error("Too many markers in map literal");
+            }
+            map.markerTiles[map.markerCount] = tile;
+            map.markerX[map.markerCount] = x;
+            map.markerY[map.markerCount] = y;
+            map.markerCount++;
+        }
+        x++;
+    }
+    if (x > 0) {
+        map.rowLengths[y] = x;
+    }
+    return map;
+}
+
+// A W x H box: walls on the edge, floor inside.
+template <int W, int H>
+constexpr StaticMap<W, H> borderMap() {
+    StaticMap<W, H> map{};
+    for (int y = 0; y < H; y++) {
+        map.rowLengths[y] = W;
+        for (int x = 0; x < W; x++) {
+            if (x == 0 || y == 0 || x == W - 1 || y == H - 1) {
+                map.setWall(x, y);
+            }
+        }
+    }
+    return map;
+}
+
+// A W x H box of dots with a pillar every SPACING cells from FIRST, as used
+// by the Pacman ghost benchmark.
+template <int W, int H, int FIRST, int SPACING>
+constexpr StaticMap<W, H> pillarMap() {
+    StaticMap<W, H> map = borderMap<W, H>();
+    for (int y = 1; y < H - 1; y++) {
+        for (int x = 1; x < W - 1; x++) {
+            bool pillar = x >= FIRST && x < W - FIRST && (x - FIRST) % SPACING == 0
+                       && y >= FIRST && y < H - FIRST && (y - FIRST) % SPACING == 0;
+            if (pillar) {
+                map.setWall(x, y);
+            } else {
+                map.setDot(x, y);
+            }
+        }
+    }
+    return map;
+}
+
+inline constexpr char DEFAULT_PACMAN_TEXT[] =
+    "####################\n"
+    "#........##........#\n"
+    "#.####...##...####.#\n"
+    "#.#  #...##...#  #.#\n"
+    "#.####...##...####.#\n"
+    "#..................#\n"
+    "#.####.######.####.#\n"
+    "#....#...##...#....#\n"
+    "####.#...##...#.####\n"
+    "#....#...##...#....#\n"
+    "#.####.######.####.#\n"
+    "#..................#\n"
+    "#.####...##...####.#\n"
+    "#.#  #...##...#  #.#\n"
+    "#.####...##...####.#\n"
+    "#........##........#\n"
+    "####################\n";
+
+inline constexpr auto DEFAULT_PACMAN_MAP = parseMap<mapTextWidth(DEFAULT_PACMAN_TEXT),
+    mapTextHeight(DEFAULT_PACMAN_TEXT)>(DEFAULT_PACMAN_TEXT);
+
+}
+
+#endif
@@ -0,0 +1,406 @@
+#ifndef DRAW_LOG_HPP_
+#define DRAW_LOG_HPP_
+
+#include "IGraphical.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// Compact binary log of IGraphical calls. A log is the magic and version
+// followed by records: one opcode byte, then LEB128 varints (zigzag for
+// coordinates), colours as four raw bytes and strings as length + bytes.
+//
+// Version 2 adds delta frames for live streams. Draw records of a frame are
+// numbered from 0; COPY n replays the next n records of the previous frame
+// unchanged, while any other draw record replaces the one at its index.
+// KEYFRAME forgets the previous frame so a viewer can start decoding there.
+class DrawLog {
+public:
+    static constexpr char MAGIC[4] = {'A', 'D', 'R', 'L'};
+    static constexpr uint8_t VERSION = 2;
+
+    enum class Op : uint8_t {
+        INIT = 1,
+        CLEAR,
+        DISPLAY,
+        CELL,
+        RECTANGLE,
+        CIRCLE,
+        SPRITE,
+        TEXT,
+        CELL_SIZE,
+        KEYFRAME,
+        COPY
+    };
+};
+
+class DrawLogWriter {
+public:
+    explicit DrawLogWriter(bool header = true) {
+        if (header) {
+            writeHeader();
+        }
+    }
+
+    void init(int width, int height) {
+        op(DrawLog::Op::INIT);
+        integer(width);
+        integer(height);
+    }
+    void clear() { op(DrawLog::Op::CLEAR); }
+    void display() { op(DrawLog::Op::DISPLAY); }
+    void cell(int x, int y, const Color &color) {
+        op(DrawLog::Op::CELL);
+        integer(x);
+        integer(y);
+        colour(color);
+    }
+    void rectangle(const Position &pos, int width, int height, const Color &color) {
+        op(DrawLog::Op::RECTANGLE);
+        integer(pos.x);
+        integer(pos.y);
+        integer(width);
+        integer(height);
+        colour(color);
+    }
+    void circle(const Position &pos, int radius, const Color &color) {
+        op(DrawLog::Op::CIRCLE);
+        integer(pos.x);
+        integer(pos.y);
+        integer(radius);
+        colour(color);
+    }
+    void sprite(const Sprite &sprite) {
+        op(DrawLog::Op::SPRITE);
+        integer(sprite.position.x);
+        integer(sprite.position.y);
+        string(sprite.path);
+    }
+    void text(const Text &text) {
+        op(DrawLog::Op::TEXT);
+        integer(text.position.x);
+        integer(text.position.y);
+        unsignedInteger(text.size);
+        colour(text.color);
+        string(text.content);
+    }
+    void cellSize(int size) {
+        op(DrawLog::Op::CELL_SIZE);
+        integer(size);
+    }
+    void keyframe() { op(DrawLog::Op::KEYFRAME); }
+    void copy(uint32_t count) {
+        op(DrawLog::Op::COPY);
+        unsignedInteger(count);
+    }
+    // Appends whole records taken from another writer's data().
+    void append(const uint8_t *records, size_t size) {
+        _records.push_back(_buffer.size());
+        _buffer.insert(_buffer.end(), records, records + size);
+    }
+
+    const std::vector<uint8_t> &data() const { return _buffer; }
+    // Offset in data() where each record written since the last drain starts.
+    const std::vector<size_t> &records() const { return _records; }
+    // Once data() has been written out, drain() empties the buffer; later
+    // records continue the same stream, without a second header.
+    void drain() {
+        _buffer.clear();
+        _records.clear();
+    }
+
+private:
+    std::vector<uint8_t> _buffer;
+    std::vector<size_t> _records;
+
+    void writeHeader() {
+        _buffer.insert(_buffer.end(), DrawLog::MAGIC, DrawLog::MAGIC + 4);
+        _buffer.push_back(DrawLog::VERSION);
+    }
+    void op(DrawLog::Op code) {
+        _records.push_back(_buffer.size());
+        _buffer.push_back(static_cast<uint8_t>(code));
+    }
+    void unsignedInteger(uint32_t value) {
+        while (value >= 0x80) {
+            _buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        _buffer.push_back(static_cast<uint8_t>(value));
+    }
+    void integer(int value) {
+        unsignedInteger((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+    void colour(const Color &color) {
+        _buffer.push_back(color.r);
+        _buffer.push_back(color.g);
+        _buffer.push_back(color.b);
+        _buffer.push_back(color.a);
+    }
+    void string(const std::string &value) {
+        unsignedInteger(static_cast<uint32_t>(value.size()));
+        _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+};
+
+// Encodes frames recorded by a headerless DrawLogWriter (draw records only,
+// no display) either whole or as a delta against the previously committed
+// frame. A delta reuses every record whose bytes match the record at the
+// same index in that frame.
+class DrawFrameEncoder {
+public:
+    void encode(const DrawLogWriter &frame, bool keyframe, DrawLogWriter &out) const {
+        const std::vector<uint8_t> &data = frame.data();
+        const std::vector<size_t> &records = frame.records();
+        if (keyframe) {
+            out.keyframe();
+            if (!data.empty()) {
+                out.append(data.data(), data.size());
+            }
+            out.display();
+            return;
+        }
+        uint32_t unchanged = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            size_t start = records[i];
+            size_t end = i + 1 < records.size() ? records[i + 1] : data.size();
+            if (i < _records.size() && sameRecord(data.data() + start, end - start, i)) {
+                unchanged++;
+                continue;
+            }
+            if (unchanged > 0) {
+                out.copy(unchanged);
+                unchanged = 0;
+            }
+            out.append(data.data() + start, end - start);
+        }
+        if (unchanged > 0) {
+            out.copy(unchanged);
+        }
+        out.display();
+    }
+
+    // Makes frame the reference for the next delta.
+    void commit(const DrawLogWriter &frame) {
+        _data = frame.data();
+        _records = frame.records();
+    }
+
+private:
+    std::vector<uint8_t> _data;
+    std::vector<size_t> _records;
+
+    bool sameRecord(const uint8_t *record, size_t size, size_t index) const {
+        size_t start = _records[index];
+        size_t end = index + 1 < _records.size() ? _records[index + 1] : _data.size();
+        return end - start == size && std::memcmp(_data.data() + start, record, size) == 0;
+    }
+};
+
+class DrawLogReader {
+public:
+    DrawLogReader(const uint8_t *data, size_t size) : _data(data), _end(data + size), _width(800), _height(600) {
+        if (size < 5 || std::memcmp(data, DrawLog::MAGIC, 4) != 0) {
+            throw std::runtime_error("Not a draw log");
+        }
+        if (data[4] == 0 || data[4] > DrawLog::VERSION) {
+            throw std::runtime_error("Unsupported draw log version " + std::to_string(data[4]));
+        }
+        _data += 5;
+    }
+
+    // Continues decoding from a new buffer, keeping the previous frame for
+    // delta records; used by stream viewers that receive one frame at a time.
+    void setInput(const uint8_t *data, size_t size) {
+        _data = data;
+        _end = data + size;
+    }
+
+    bool atEnd() const { return _data >= _end; }
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+    // Consumes a leading INIT record, if any, so a player can size its
+    // window before the first frame.
+    void readInit() {
+        if (!atEnd() && static_cast<DrawLog::Op>(*_data) == DrawLog::Op::INIT) {
+            _data++;
+            _width = integer();
+            _height = integer();
+        }
+    }
+
+    // Replays records on target up to and including the next display().
+    // Returns false when the log ends before a complete frame.
+    bool playFrame(IGraphical &target) {
+        while (!atEnd()) {
+            const uint8_t *record = _data;
+            DrawLog::Op code = static_cast<DrawLog::Op>(*_data++);
+            switch (code) {
+                case DrawLog::Op::INIT:
+                    _width = integer();
+                    _height = integer();
+                    break;
+                case DrawLog::Op::DISPLAY:
+                    target.display();
+                    _previous.swap(_current);
+                    _previousRecords.swap(_currentRecords);
+                    _current.clear();
+                    _currentRecords.clear();
+                    return true;
+                case DrawLog::Op::KEYFRAME:
+                    _previous.clear();
+                    _previousRecords.clear();
+                    _current.clear();
+                    _currentRecords.clear();
+                    break;
+                case DrawLog::Op::COPY:
+                    copyPrevious(unsignedInteger(), target);
+                    break;
+                default:
+                    play(code, target);
+                    keep(record, static_cast<size_t>(_data - record));
+                    break;
+            }
+        }
+        return false;
+    }
+
+private:
+    const uint8_t *_data;
+    const uint8_t *_end;
+    int _width;
+    int _height;
+    // Draw records of the previous and current frame, for COPY.
+    std::vector<uint8_t> _previous;
+    std::vector<size_t> _previousRecords;
+    std::vector<uint8_t> _current;
+    std::vector<size_t> _currentRecords;
+
+    void play(DrawLog::Op code, IGraphical &target) {
+        switch (code) {
+            case DrawLog::Op::CLEAR:
+                target.clear();
+                break;
+            case DrawLog::Op::CELL: {
+                int x = integer();
+                int y = integer();
+                target.drawCell(x, y, colour());
+                break;
+            }
+            case DrawLog::Op::RECTANGLE: {
+                Position pos;
+                pos.x = integer();
+                pos.y = integer();
+                int width = integer();
+                int height = integer();
+                target.drawRectangle(pos, width, height, colour());
+                break;
+            }
+            case DrawLog::Op::CIRCLE: {
+                Position pos;
+                pos.x = integer();
+                pos.y = integer();
+                int radius = integer();
+                target.drawCircle(pos, radius, colour());
+                break;
+            }
+            case DrawLog::Op::SPRITE: {
+                Sprite sprite;
+                sprite.position.x = integer();
+                sprite.position.y = integer();
+                sprite.path = string();
+                target.drawSprite(sprite);
+                break;
+            }
+            case DrawLog::Op::TEXT: {
+                Text text;
+                text.position.x = integer();
+                text.position.y = integer();
+                text.size = unsignedInteger();
+                text.color = colour();
+                text.content = string();
+                target.drawText(text);
+                break;
+            }
+            case DrawLog::Op::CELL_SIZE:
+                target.setCellSize(integer());
+                break;
+            default:
+                throw std::runtime_error("Corrupted draw log: unknown opcode " + std::to_string(static_cast<int>(code)));
+        }
+    }
+
+    void keep(const uint8_t *record, size_t size) {
+        _currentRecords.push_back(_current.size());
+        _current.insert(_current.end(), record, record + size);
+    }
+
+    // Replays the next count records of the previous frame, at the index
+    // the current frame has reached.
+    void copyPrevious(uint32_t count, IGraphical &target) {
+        size_t first = _currentRecords.size();
+        if (count > _previousRecords.size() || first > _previousRecords.size() - count) {
+            throw std::runtime_error("Corrupted draw log: copy past the previous frame");
+        }
+        const uint8_t *savedData = _data;
+        const uint8_t *savedEnd = _end;
+        for (size_t i = first; i < first + count; i++) {
+            size_t start = _previousRecords[i];
+            size_t end = i + 1 < _previousRecords.size() ? _previousRecords[i + 1] : _previous.size();
+            _data = _previous.data() + start;
+            _end = _previous.data() + end;
+            play(static_cast<DrawLog::Op>(*_data++), target);
+            keep(_previous.data() + start, end - start);
+        }
+        _data = savedData;
+        _end = savedEnd;
+    }
+
+    uint8_t byte() {
+        if (_data >= _end) {
+            throw std::runtime_error("Corrupted draw log: truncated record");
+        }
+        return *_data++;
+    }
+    uint32_t unsignedInteger() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = byte();
+            value |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Corrupted draw log: varint too long");
+    }
+    int integer() {
+        uint32_t value = unsignedInteger();
+        return static_cast<int>((value >> 1) ^ (~(value & 1) + 1));
+    }
+    Color colour() {
+        Color color;
+        color.r = byte();
+        color.g = byte();
+        color.b = byte();
+        color.a = byte();
+        return color;
+    }
+    std::string string() {
+        uint32_t length = unsignedInteger();
+        if (static_cast<size_t>(_end - _data) < length) {
+            throw std::runtime_error("Corrupted draw log: truncated string");
+        }
+        std::string value(reinterpret_cast<const char *>(_data), length);
+        _data += length;
+        return value;
+    }
+};
+
+}
+
+#endif
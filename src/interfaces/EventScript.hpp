@@ -0,0 +1,61 @@
+#ifndef EVENT_SCRIPT_HPP_
+#define EVENT_SCRIPT_HPP_
+
+#include "IGraphical.hpp"
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace arcade {
+
+// Scripted input for unattended runs: comma separated "tick:EVENT" entries,
+// e.g. "1:ACTION,60:MOVE_UP", with events named as in EventType. Entries
+// are expected in tick order.
+using EventScript = std::vector<std::pair<size_t, EventType>>;
+
+inline EventType parseEventName(const std::string &name) {
+    static const std::pair<const char *, EventType> names[] = {
+        {"QUIT", EventType::QUIT},
+        {"MOVE_UP", EventType::MOVE_UP},
+        {"MOVE_DOWN", EventType::MOVE_DOWN},
+        {"MOVE_LEFT", EventType::MOVE_LEFT},
+        {"MOVE_RIGHT", EventType::MOVE_RIGHT},
+        {"ACTION", EventType::ACTION},
+        {"PAUSE", EventType::PAUSE},
+        {"MENU", EventType::MENU},
+        {"NEXT_LIB", EventType::NEXT_LIB},
+        {"PREV_LIB", EventType::PREV_LIB},
+        {"NEXT_GAME", EventType::NEXT_GAME},
+        {"PREV_GAME", EventType::PREV_GAME},
+        {"REWIND", EventType::REWIND}
+    };
+    for (const auto &entry : names) {
+        if (name == entry.first) {
+            return entry.second;
+        }
+    }
+    throw std::runtime_error("Unknown event in script: " + name);
+}
+
+inline EventScript parseEventScript(const std::string &script) {
+    EventScript events;
+    std::stringstream stream(script);
+    std::string entry;
+
+    while (std::getline(stream, entry, ',')) {
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos) {
+            throw std::runtime_error("Malformed event script entry: " + entry);
+        }
+        size_t tick = std::strtoul(entry.substr(0, colon).c_str(), nullptr, 10);
+        events.emplace_back(tick, parseEventName(entry.substr(colon + 1)));
+    }
+    return events;
+}
+
+}
+
+#endif
@@ -0,0 +1,414 @@
+#ifndef GRID_HPP_
+#define GRID_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// One bit per cell of a width x height board. Rows are padded to whole
+// 64-bit words and the padding bits are kept at zero, so counts and bulk
+// operations can work a word at a time.
+class GridLayer {
+public:
+    GridLayer() : _width(0), _height(0), _stride(0) {}
+
+    void resize(int width, int height) {
+        _width = width > 0 ? width : 0;
+        _height = height > 0 ? height : 0;
+        _stride = (_width + 63) / 64;
+        _words.assign(static_cast<size_t>(_stride) * _height, 0);
+    }
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    bool inBounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(_width)
+            && static_cast<unsigned>(y) < static_cast<unsigned>(_height);
+    }
+
+    // Cells outside the board read as clear and ignore writes.
+    bool test(int x, int y) const {
+        return inBounds(x, y) && ((word(x, y) >> (x & 63)) & 1);
+    }
+    void set(int x, int y) {
+        if (inBounds(x, y)) {
+            word(x, y) |= bit(x);
+        }
+    }
+    void reset(int x, int y) {
+        if (inBounds(x, y)) {
+            word(x, y) &= ~bit(x);
+        }
+    }
+    void assign(int x, int y, bool value) {
+        if (value) {
+            set(x, y);
+        } else {
+            reset(x, y);
+        }
+    }
+    void clear() { _words.assign(_words.size(), 0); }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : _words) {
+            total += __builtin_popcountll(w);
+        }
+        return total;
+    }
+    bool any() const {
+        for (uint64_t w : _words) {
+            if (w) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls fn(x, y) for every set cell in row-major order, skipping empty
+    // words whole.
+    template <typename Fn>
+    void forEach(Fn &&fn) const {
+        for (int y = 0; y < _height; y++) {
+            const uint64_t *row = &_words[static_cast<size_t>(y) * _stride];
+            for (int i = 0; i < _stride; i++) {
+                uint64_t w = row[i];
+                while (w) {
+                    fn(i * 64 + __builtin_ctzll(w), y);
+                    w &= w - 1;
+                }
+            }
+        }
+    }
+
+    // Word-parallel combination with a layer of the same size.
+    GridLayer &operator|=(const GridLayer &other) {
+        for (size_t i = 0; i < _words.size() && i < other._words.size(); i++) {
+            _words[i] |= other._words[i];
+        }
+        return *this;
+    }
+    GridLayer &operator&=(const GridLayer &other) {
+        for (size_t i = 0; i < _words.size(); i++) {
+            _words[i] &= i < other._words.size() ? other._words[i] : 0;
+        }
+        return *this;
+    }
+    GridLayer &andNot(const GridLayer &other) {
+        for (size_t i = 0; i < _words.size() && i < other._words.size(); i++) {
+            _words[i] &= ~other._words[i];
+        }
+        return *this;
+    }
+
+    const std::vector<uint64_t> &words() const { return _words; }
+    int getStride() const { return _stride; }
+
+    // Replaces the words of the layer, e.g. with ones read from a file;
+    // bits in row padding are dropped.
+    void assignWords(const std::vector<uint64_t> &words) {
+        uint64_t lastMask = (_width & 63) ? (uint64_t(1) << (_width & 63)) - 1 : ~uint64_t(0);
+        for (size_t i = 0; i < _words.size(); i++) {
+            _words[i] = i < words.size() ? words[i] : 0;
+            if (static_cast<int>(i % _stride) == _stride - 1) {
+                _words[i] &= lastMask;
+            }
+        }
+    }
+
+    // Clears the layer, then copies rows of a smaller or equal board
+    // packed the same way with the given stride into its top-left corner.
+    void assignRows(const uint64_t *words, int stride, int rows) {
+        clear();
+        int copied = stride < _stride ? stride : _stride;
+        for (int y = 0; y < rows && y < _height; y++) {
+            for (int i = 0; i < copied; i++) {
+                _words[static_cast<size_t>(y) * _stride + i] = words[static_cast<size_t>(y) * stride + i];
+            }
+        }
+    }
+
+private:
+    int _width;
+    int _height;
+    int _stride;
+    std::vector<uint64_t> _words;
+
+    static uint64_t bit(int x) { return uint64_t(1) << (x & 63); }
+    uint64_t &word(int x, int y) { return _words[static_cast<size_t>(y) * _stride + (x >> 6)]; }
+    uint64_t word(int x, int y) const { return _words[static_cast<size_t>(y) * _stride + (x >> 6)]; }
+};
+
+// Occupancy of a grid game: static walls, moving bodies (snake segments)
+// and collectible items (food, dots). Every query is a single bit test and
+// the edge of the board behaves as a wall.
+class Grid {
+public:
+    enum Layer {
+        WALLS,
+        BODIES,
+        ITEMS,
+        LAYER_COUNT
+    };
+
+    void resize(int width, int height) {
+        for (auto &layer : _layers) {
+            layer.resize(width, height);
+        }
+    }
+
+    int getWidth() const { return _layers[WALLS].getWidth(); }
+    int getHeight() const { return _layers[WALLS].getHeight(); }
+    bool inBounds(int x, int y) const { return _layers[WALLS].inBounds(x, y); }
+
+    GridLayer &layer(Layer which) { return _layers[which]; }
+    const GridLayer &layer(Layer which) const { return _layers[which]; }
+    GridLayer &walls() { return _layers[WALLS]; }
+    const GridLayer &walls() const { return _layers[WALLS]; }
+    GridLayer &bodies() { return _layers[BODIES]; }
+    const GridLayer &bodies() const { return _layers[BODIES]; }
+    GridLayer &items() { return _layers[ITEMS]; }
+    const GridLayer &items() const { return _layers[ITEMS]; }
+
+    bool isWall(int x, int y) const {
+        return !inBounds(x, y) || _layers[WALLS].test(x, y);
+    }
+    bool isBlocked(int x, int y) const {
+        return !inBounds(x, y) || _layers[WALLS].test(x, y) || _layers[BODIES].test(x, y);
+    }
+    bool hasItem(int x, int y) const { return _layers[ITEMS].test(x, y); }
+
+    // Calls fn(x, y) for each non-wall cell next to (x, y), in the order
+    // up, right, down, left.
+    template <typename Fn>
+    void forEachNeighbour(int x, int y, Fn &&fn) const {
+        if (!isWall(x, y - 1)) fn(x, y - 1);
+        if (!isWall(x + 1, y)) fn(x + 1, y);
+        if (!isWall(x, y + 1)) fn(x, y + 1);
+        if (!isWall(x - 1, y)) fn(x - 1, y);
+    }
+
+    // Cells neither walled nor occupied by a body, counted a word at a time.
+    size_t countFree() const {
+        const std::vector<uint64_t> &walls = _layers[WALLS].words();
+        const std::vector<uint64_t> &bodies = _layers[BODIES].words();
+        int stride = _layers[WALLS].getStride();
+        int width = getWidth();
+        uint64_t lastMask = (width & 63) ? (uint64_t(1) << (width & 63)) - 1 : ~uint64_t(0);
+        size_t total = 0;
+        for (size_t i = 0; i < walls.size(); i++) {
+            uint64_t free = ~(walls[i] | bodies[i]);
+            if (static_cast<int>(i % stride) == stride - 1) {
+                free &= lastMask;
+            }
+            total += __builtin_popcountll(free);
+        }
+        return total;
+    }
+
+private:
+    GridLayer _layers[LAYER_COUNT];
+};
+
+// Cells where an item can be spawned: inside the board, reachable from a
+// start cell without crossing walls, and holding neither a body nor an
+// item. Cells sit in a dense array with a per-cell slot, so insert, erase
+// and uniform sampling are all O(1); only rebuild() walks the board, and it
+// is needed only when the walls change.
+class FreeCells {
+public:
+    FreeCells() : _width(0) {}
+
+    void rebuild(const Grid &grid, int startX, int startY) {
+        int width = grid.getWidth();
+        int height = grid.getHeight();
+        _width = width;
+        _reachable.resize(width, height);
+        _slots.assign(static_cast<size_t>(width) * height, -1);
+        _cells.clear();
+        _cells.reserve(_slots.size());
+
+        if (!grid.isWall(startX, startY)) {
+            std::vector<int> pending;
+            pending.reserve(_slots.size());
+            _reachable.set(startX, startY);
+            pending.push_back(startY * width + startX);
+            static const int dx[4] = {0, 1, 0, -1};
+            static const int dy[4] = {-1, 0, 1, 0};
+            while (!pending.empty()) {
+                int cell = pending.back();
+                pending.pop_back();
+                for (int d = 0; d < 4; d++) {
+                    int x = cell % width + dx[d];
+                    int y = cell / width + dy[d];
+                    if (!grid.isWall(x, y) && !_reachable.test(x, y)) {
+                        _reachable.set(x, y);
+                        pending.push_back(y * width + x);
+                    }
+                }
+            }
+        }
+
+        _reachable.forEach([this, &grid](int x, int y) {
+            if (!grid.bodies().test(x, y) && !grid.hasItem(x, y)) {
+                insert(x, y);
+            }
+        });
+    }
+
+    // Adds a cell that became free; ignored when unreachable or present.
+    void insert(int x, int y) {
+        if (!_reachable.test(x, y)) {
+            return;
+        }
+        int cell = y * _width + x;
+        if (_slots[cell] >= 0) {
+            return;
+        }
+        _slots[cell] = static_cast<int>(_cells.size());
+        _cells.push_back(cell);
+    }
+
+    void erase(int x, int y) {
+        if (!_reachable.test(x, y)) {
+            return;
+        }
+        int cell = y * _width + x;
+        int slot = _slots[cell];
+        if (slot < 0) {
+            return;
+        }
+        int last = _cells.back();
+        _cells[slot] = last;
+        _slots[last] = slot;
+        _cells.pop_back();
+        _slots[cell] = -1;
+    }
+
+    bool contains(int x, int y) const {
+        return _reachable.test(x, y) && _slots[y * _width + x] >= 0;
+    }
+    bool isReachable(int x, int y) const { return _reachable.test(x, y); }
+    size_t size() const { return _cells.size(); }
+    // The free cells in sampling order. Handing them back to assignCells()
+    // after a rebuild() over the same board restores that order, so
+    // sample() draws exactly as it did; unreachable cells are skipped.
+    const std::vector<int> &cells() const { return _cells; }
+    void assignCells(const std::vector<int> &cells) {
+        for (int cell : _cells) {
+            _slots[cell] = -1;
+        }
+        _cells.clear();
+        for (int cell : cells) {
+            if (cell >= 0 && static_cast<size_t>(cell) < _slots.size() && _slots[cell] < 0
+                && _reachable.test(cell % _width, cell / _width)) {
+                _slots[cell] = static_cast<int>(_cells.size());
+                _cells.push_back(cell);
+            }
+        }
+    }
+    bool empty() const { return _cells.empty(); }
+
+    // Free cell number random % size(); pass any uniform random number.
+    void sample(unsigned random, int &x, int &y) const {
+        int cell = _cells[random % _cells.size()];
+        x = cell % _width;
+        y = cell / _width;
+    }
+
+private:
+    int _width;
+    GridLayer _reachable;
+    std::vector<int> _slots;
+    std::vector<int> _cells;
+};
+
+// Breadth-first distance field towards one target cell, with the next cell
+// of a shortest path stored for every cell that can reach it. One compute()
+// serves any number of chasers: each move is then a single table lookup.
+// Any board with getWidth(), getHeight(), isWall() and forEachNeighbour()
+// works, so mazes with tunnels get paths through them; moves must be
+// reversible. Buffers are kept between computes, so retargeting allocates
+// only when the board grows. The tables are also exposed whole: a cell
+// that cannot get closer (the target, walls, cut-off cells) is its own
+// next cell, so a column of cell indices advances with one gather.
+class FlowField {
+public:
+    FlowField() : _width(0), _targetX(-1), _targetY(-1) {}
+
+    template <typename Board>
+    void compute(const Board &board, int targetX, int targetY) {
+        int width = board.getWidth();
+        size_t cells = static_cast<size_t>(width) * board.getHeight();
+        _width = width;
+        _targetX = targetX;
+        _targetY = targetY;
+        _distance.assign(cells, -1);
+        _next.resize(cells);
+        for (size_t cell = 0; cell < cells; cell++) {
+            _next[cell] = static_cast<int>(cell);
+        }
+        _queue.resize(cells);
+        if (board.isWall(targetX, targetY)) {
+            return;
+        }
+
+        size_t head = 0;
+        size_t tail = 0;
+        int target = targetY * width + targetX;
+        _distance[target] = 0;
+        _queue[tail++] = target;
+        while (head < tail) {
+            int cell = _queue[head++];
+            board.forEachNeighbour(cell % width, cell / width, [&](int x, int y) {
+                int next = y * width + x;
+                if (_distance[next] < 0) {
+                    _distance[next] = _distance[cell] + 1;
+                    _next[next] = cell;
+                    _queue[tail++] = next;
+                }
+            });
+        }
+    }
+
+    bool hasTarget(int x, int y) const { return x == _targetX && y == _targetY; }
+
+    // Steps from the target, or -1 when the cell cannot reach it.
+    int distance(int x, int y) const {
+        if (static_cast<unsigned>(x) >= static_cast<unsigned>(_width) || y < 0
+            || static_cast<size_t>(y) * _width + x >= _distance.size()) {
+            return -1;
+        }
+        return _distance[static_cast<size_t>(y) * _width + x];
+    }
+
+    // Moves (x, y) one cell closer to the target; false when it is already
+    // there or cannot reach it.
+    bool advance(int &x, int &y) const {
+        if (distance(x, y) <= 0) {
+            return false;
+        }
+        int next = _next[static_cast<size_t>(y) * _width + x];
+        x = next % _width;
+        y = next / _width;
+        return true;
+    }
+
+    // Per cell, indexed y * width + x.
+    const int *distances() const { return _distance.data(); }
+    const int *nextCells() const { return _next.data(); }
+
+private:
+    int _width;
+    int _targetX;
+    int _targetY;
+    std::vector<int> _distance;
+    std::vector<int> _next;
+    std::vector<int> _queue;
+};
+
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define IGAME_HPP_
 
 #include "IGraphical.hpp"
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace arcade {
 
@@ -30,6 +32,14 @@ public:
     virtual void setState(GameState state) = 0;
     virtual std::string getName() const = 0;
     virtual std::string getDescription() const = 0;
+
+    // Copies the whole game into buffer (a flat Snapshot.hpp record, reusing
+    // the buffer's storage), cheaply enough to do every tick. restore()
+    // brings back what snapshot() wrote, on this instance or a fresh one;
+    // it returns false and leaves the game alone for a buffer written by
+    // another game or another version of this one.
+    virtual void snapshot(std::vector<uint8_t> &buffer) const = 0;
+    virtual bool restore(const std::vector<uint8_t> &buffer) = 0;
 };
 
 }
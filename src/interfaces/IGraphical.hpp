@@ -20,7 +20,8 @@ enum class EventType {
     NEXT_LIB,
     PREV_LIB,
     NEXT_GAME,
-    PREV_GAME
+    PREV_GAME,
+    REWIND
 };
 
 struct Color {
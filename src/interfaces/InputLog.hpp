@@ -0,0 +1,112 @@
+#ifndef INPUT_LOG_HPP_
+#define INPUT_LOG_HPP_
+
+#include "IGraphical.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// A recorded session: everything Core took from the outside world, so that
+// replaying it runs the games through the same states. A log is the magic
+// and version, the session seed as a LEB128 varint, then one varint per
+// event Core polled: the tick's duration in microseconds shifted left by
+// EVENT_BITS, or'ed with the EventType. Polls made within a tick (the menu,
+// the game over screen) carry a duration of 0, so an idle tick costs three
+// bytes and an inner poll one.
+class InputLog {
+public:
+    static constexpr char MAGIC[4] = {'A', 'I', 'N', 'P'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int EVENT_BITS = 4;
+};
+
+class InputLogWriter {
+public:
+    explicit InputLogWriter(uint64_t seed) {
+        _buffer.assign(InputLog::MAGIC, InputLog::MAGIC + 4);
+        _buffer.push_back(InputLog::VERSION);
+        unsignedInteger(seed);
+    }
+
+    void event(uint32_t micros, EventType type) {
+        unsignedInteger((static_cast<uint64_t>(micros) << InputLog::EVENT_BITS) | static_cast<uint64_t>(type));
+    }
+
+    const std::vector<uint8_t> &data() const { return _buffer; }
+    // Once data() has been written out, drain() empties the buffer; later
+    // events continue the same log.
+    void drain() { _buffer.clear(); }
+
+private:
+    std::vector<uint8_t> _buffer;
+
+    void unsignedInteger(uint64_t value) {
+        while (value >= 0x80) {
+            _buffer.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        _buffer.push_back(static_cast<uint8_t>(value));
+    }
+};
+
+class InputLogReader {
+public:
+    // Reads the header; data must outlive the reader.
+    InputLogReader(const uint8_t *data, size_t size) : _data(data), _end(data + size), _seed(0) {
+        if (size < 5 || std::memcmp(data, InputLog::MAGIC, 4) != 0) {
+            throw std::runtime_error("Not an input log");
+        }
+        if (data[4] == 0 || data[4] > InputLog::VERSION) {
+            throw std::runtime_error("Unsupported input log version " + std::to_string(data[4]));
+        }
+        _data += 5;
+        _seed = unsignedInteger();
+    }
+
+    uint64_t getSeed() const { return _seed; }
+    bool atEnd() const { return _data >= _end; }
+
+    // The next polled event and the duration of its tick; false at the end
+    // of the log.
+    bool next(uint32_t &micros, EventType &type) {
+        if (atEnd()) {
+            return false;
+        }
+        uint64_t value = unsignedInteger();
+        uint64_t event = value & ((1u << InputLog::EVENT_BITS) - 1);
+        if (event > static_cast<uint64_t>(EventType::REWIND)) {
+            throw std::runtime_error("Corrupted input log: unknown event " + std::to_string(event));
+        }
+        micros = static_cast<uint32_t>(value >> InputLog::EVENT_BITS);
+        type = static_cast<EventType>(event);
+        return true;
+    }
+
+private:
+    const uint8_t *_data;
+    const uint8_t *_end;
+    uint64_t _seed;
+
+    uint64_t unsignedInteger() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_data >= _end) {
+                throw std::runtime_error("Corrupted input log: truncated record");
+            }
+            uint8_t b = *_data++;
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Corrupted input log: varint too long");
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef MAP_FILE_HPP_
+#define MAP_FILE_HPP_
+
+#include "IGraphical.hpp"
+#include "Grid.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// A text map parsed into what the games use: '#' cells as a wall layer and
+// a wall list, '.' cells as a dot layer, and every other non-space
+// character (spawn points and the like) as a marker. Row lengths are kept
+// because short rows matter to Pacman's tunnels.
+//
+// The binary form, written by arcade_mapc, is little-endian: the magic and
+// version, width, height, wall and marker counts as u32, then the u32 row
+// lengths, the wall and dot layers as GridLayer words (u64, rows padded to
+// whole words), the walls as (u16 x, u16 y) and the markers as (u8 tile,
+// u16 x, u16 y). decode() checks every size and coordinate, so a loaded map
+// can be trusted without rescanning.
+struct CompiledMap {
+    static constexpr char MAGIC[4] = {'A', 'M', 'A', 'P'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int MAX_SIDE = 65535;
+
+    struct Marker {
+        char tile;
+        Position position;
+    };
+
+    int width = 0;
+    int height = 0;
+    std::vector<int> rowLengths;
+    GridLayer walls;
+    GridLayer dots;
+    std::vector<Position> wallCells;
+    std::vector<Marker> markers;
+
+    static CompiledMap fromText(const std::vector<std::string> &rows) {
+        CompiledMap map;
+        map.height = static_cast<int>(rows.size());
+        for (const auto &row : rows) {
+            map.width = std::max(map.width, static_cast<int>(row.size()));
+            map.rowLengths.push_back(static_cast<int>(row.size()));
+        }
+        if (map.width > MAX_SIDE || map.height > MAX_SIDE) {
+            throw std::runtime_error("Map too large");
+        }
+        map.walls.resize(map.width, map.height);
+        map.dots.resize(map.width, map.height);
+        for (int y = 0; y < map.height; y++) {
+            for (int x = 0; x < map.rowLengths[y]; x++) {
+                char tile = rows[y][x];
+                if (tile == '#') {
+                    map.walls.set(x, y);
+                    map.wallCells.push_back(Position(x, y));
+                } else if (tile == '.') {
+                    map.dots.set(x, y);
+                } else if (tile != ' ') {
+                    map.markers.push_back({tile, Position(x, y)});
+                }
+            }
+        }
+        return map;
+    }
+
+    // Copies the walls into a layer at least as large as the map.
+    void stampWalls(GridLayer &layer) const {
+        if (layer.getWidth() == width && layer.getHeight() == height) {
+            layer = walls;
+            return;
+        }
+        layer.clear();
+        for (const auto &cell : wallCells) {
+            layer.set(cell.x, cell.y);
+        }
+    }
+
+    std::vector<uint8_t> encode() const {
+        std::vector<uint8_t> out(MAGIC, MAGIC + 4);
+        out.push_back(VERSION);
+        out.insert(out.end(), 3, 0);
+        put(out, width, 4);
+        put(out, height, 4);
+        put(out, wallCells.size(), 4);
+        put(out, markers.size(), 4);
+        for (int length : rowLengths) {
+            put(out, length, 4);
+        }
+        for (uint64_t word : walls.words()) {
+            put(out, word, 8);
+        }
+        for (uint64_t word : dots.words()) {
+            put(out, word, 8);
+        }
+        for (const auto &cell : wallCells) {
+            put(out, cell.x, 2);
+            put(out, cell.y, 2);
+        }
+        for (const auto &marker : markers) {
+            put(out, static_cast<uint8_t>(marker.tile), 1);
+            put(out, marker.position.x, 2);
+            put(out, marker.position.y, 2);
+        }
+        return out;
+    }
+
+    static CompiledMap decode(const uint8_t *data, size_t size) {
+        if (size < 24 || std::memcmp(data, MAGIC, 4) != 0) {
+            throw std::runtime_error("Not a compiled map");
+        }
+        if (data[4] != VERSION) {
+            throw std::runtime_error("Unsupported compiled map version " + std::to_string(data[4]));
+        }
+        CompiledMap map;
+        map.width = static_cast<int>(get(data + 8, 4));
+        map.height = static_cast<int>(get(data + 12, 4));
+        uint64_t wallCount = get(data + 16, 4);
+        uint64_t markerCount = get(data + 20, 4);
+        if (map.width < 0 || map.width > MAX_SIDE || map.height < 0 || map.height > MAX_SIDE) {
+            throw std::runtime_error("Corrupted compiled map: bad size");
+        }
+        map.walls.resize(map.width, map.height);
+        map.dots.resize(map.width, map.height);
+        size_t words = map.walls.words().size();
+        uint64_t expected = 24 + 4 * static_cast<uint64_t>(map.height) + 16 * static_cast<uint64_t>(words)
+                          + 4 * wallCount + 5 * markerCount;
+        if (size != expected) {
+            throw std::runtime_error("Corrupted compiled map: truncated or oversized");
+        }
+
+        const uint8_t *cursor = data + 24;
+        for (int y = 0; y < map.height; y++, cursor += 4) {
+            int length = static_cast<int>(get(cursor, 4));
+            if (length < 0 || length > map.width) {
+                throw std::runtime_error("Corrupted compiled map: bad row length");
+            }
+            map.rowLengths.push_back(length);
+        }
+        cursor = readLayer(map.walls, cursor);
+        cursor = readLayer(map.dots, cursor);
+        map.wallCells.reserve(wallCount);
+        for (uint64_t i = 0; i < wallCount; i++, cursor += 4) {
+            Position cell(static_cast<int>(get(cursor, 2)), static_cast<int>(get(cursor + 2, 2)));
+            if (!map.walls.test(cell.x, cell.y)) {
+                throw std::runtime_error("Corrupted compiled map: wall list does not match");
+            }
+            map.wallCells.push_back(cell);
+        }
+        if (map.wallCells.size() != map.walls.count()) {
+            throw std::runtime_error("Corrupted compiled map: wall list does not match");
+        }
+        for (uint64_t i = 0; i < markerCount; i++, cursor += 5) {
+            Position cell(static_cast<int>(get(cursor + 1, 2)), static_cast<int>(get(cursor + 3, 2)));
+            if (!map.walls.inBounds(cell.x, cell.y)) {
+                throw std::runtime_error("Corrupted compiled map: marker outside the map");
+            }
+            map.markers.push_back({static_cast<char>(cursor[0]), cell});
+        }
+        return map;
+    }
+
+private:
+    static void put(std::vector<uint8_t> &out, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    static uint64_t get(const uint8_t *in, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    // Fills layer from stored words, rejecting bits set in row padding.
+    static const uint8_t *readLayer(GridLayer &layer, const uint8_t *cursor) {
+        std::vector<uint64_t> words(layer.words().size());
+        for (auto &word : words) {
+            word = get(cursor, 8);
+            cursor += 8;
+        }
+        layer.assignWords(words);
+        if (layer.words() != words) {
+            throw std::runtime_error("Corrupted compiled map: bits outside the map");
+        }
+        return cursor;
+    }
+};
+
+}
+
+#endif
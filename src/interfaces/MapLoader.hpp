@@ -1,16 +1,97 @@
 #ifndef MAP_LOADER_HPP_
 #define MAP_LOADER_HPP_
 
+#include "MapFile.hpp"
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iostream>
 #include <stdexcept>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace arcade {
 
 class MapLoader {
 public:
+    // The map at filename, parsed once per process: later calls, from a
+    // restart or a level change, return the cached copy without touching
+    // the disk. A compiled .amap next to the text file (see arcade_mapc) is
+    // mapped into memory and preferred while it is not older than the text
+    // and decodes cleanly.
+    static std::shared_ptr<const CompiledMap> load(const std::string& filename) {
+        static std::mutex mutex;
+        static std::map<std::string, std::shared_ptr<const CompiledMap>> cache;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto cached = cache.find(filename);
+        if (cached != cache.end()) {
+            return cached->second;
+        }
+        std::shared_ptr<const CompiledMap> map;
+        for (const std::string &path : {filename, "assets/maps/" + filename}) {
+            std::string compiled = compiledPath(path);
+            std::error_code error;
+            if (std::filesystem::exists(compiled, error) && !isStale(compiled, path)) {
+                // The compiled file only speeds loading up: when it cannot
+                // be used, the text next to it still holds the level.
+                try {
+                    map = std::make_shared<CompiledMap>(loadCompiled(compiled));
+                } catch (const std::exception &e) {
+                    std::cerr << "Warning: " << e.what() << ", reading " << path << " instead" << std::endl;
+                }
+                break;
+            }
+        }
+        if (!map) {
+            map = std::make_shared<CompiledMap>(CompiledMap::fromText(loadMap(filename)));
+        }
+        cache.emplace(filename, map);
+        return map;
+    }
+
+    // map.txt -> map.amap; other names get .amap appended.
+    static std::string compiledPath(const std::string& filename) {
+        std::filesystem::path path(filename);
+        if (path.extension() == ".txt") {
+            path.replace_extension(".amap");
+            return path.string();
+        }
+        return filename + ".amap";
+    }
+
+    static CompiledMap loadCompiled(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open compiled map: " + filename);
+        }
+        struct stat info;
+        if (fstat(fd, &info) < 0 || info.st_size == 0) {
+            close(fd);
+            throw std::runtime_error("Compiled map is empty: " + filename);
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map compiled map: " + filename);
+        }
+        try {
+            CompiledMap map = CompiledMap::decode(static_cast<const uint8_t *>(data), size);
+            munmap(data, size);
+            return map;
+        } catch (const std::exception &e) {
+            munmap(data, size);
+            throw std::runtime_error(filename + ": " + e.what());
+        }
+    }
+
     static std::vector<std::string> loadMap(const std::string& filename) {
         std::vector<std::string> map;
         std::ifstream file(filename);
@@ -34,41 +115,15 @@ public:
         return map;
     }
 
-    static std::string getDefaultMap(const std::string& gameName) {
-        if (gameName == "Pacman") {
-            return std::string(
-                "####################\n"
-                "#........##........#\n"
-                "#.####...##...####.#\n"
-                "#.#  #...##...#  #.#\n"
-                "#.####...##...####.#\n"
-                "#..................#\n"
-                "#.####.######.####.#\n"
-                "#....#...##...#....#\n"
-                "####.#...##...#.####\n"
-                "#....#...##...#....#\n"
-                "#.####.######.####.#\n"
-                "#..................#\n"
-                "#.####...##...####.#\n"
-                "#.#  #...##...#  #.#\n"
-                "#.####...##...####.#\n"
-                "#........##........#\n"
-                "####################\n"
-            );
+    // A compiled map is stale when its text source has been edited since.
+    static bool isStale(const std::string& compiled, const std::string& text) {
+        std::error_code error;
+        auto textTime = std::filesystem::last_write_time(text, error);
+        if (error) {
+            return false;
         }
-        return std::string(
-            "####################\n"
-            "#                  #\n"
-            "#   ##########     #\n"
-            "#                  #\n"
-            "#     ##########   #\n"
-            "#                  #\n"
-            "#   ##########     #\n"
-            "#                  #\n"
-            "#     ##########   #\n"
-            "#                  #\n"
-            "####################\n"
-        );
+        auto compiledTime = std::filesystem::last_write_time(compiled, error);
+        return error || compiledTime < textTime;
     }
 };
 
@@ -0,0 +1,96 @@
+#ifndef RANDOM_HPP_
+#define RANDOM_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+namespace arcade {
+
+// A game's own random number generator, xoshiro128** seeded through
+// splitmix64. Every instance owns one, so two games (or two threads) never
+// share state the way rand() does, and a game started from the same seed
+// makes the same choices: the seed is all a replay needs to know about its
+// randomness. Satisfies UniformRandomBitGenerator, and operator() can be
+// handed to anything that wants rand()-style numbers.
+class Random {
+public:
+    using result_type = uint32_t;
+
+    explicit Random(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        _seed = seed;
+        for (auto &word : _state) {
+            word = static_cast<uint32_t>(splitmix(seed) >> 32);
+        }
+    }
+    uint64_t getSeed() const { return _seed; }
+
+    uint32_t operator()() {
+        uint32_t result = rotl(_state[1] * 5, 7) * 9;
+        uint32_t t = _state[1] << 9;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 11);
+        return result;
+    }
+
+    // Uniform in [0, bound), by multiply and shift rather than modulo.
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>((static_cast<uint64_t>((*this)()) * bound) >> 32);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    // The seed asked for with ARCADE_SEED (set by arcade --seed); false
+    // when unset or not a number.
+    static bool seedFromEnvironment(uint64_t &seed) {
+        const char *value = std::getenv("ARCADE_SEED");
+        if (!value || *value == '\0') {
+            return false;
+        }
+        char *end = nullptr;
+        unsigned long long parsed = std::strtoull(value, &end, 0);
+        if (*end != '\0') {
+            return false;
+        }
+        seed = parsed;
+        return true;
+    }
+
+    // ARCADE_SEED when given, else a fresh seed for every call.
+    static uint64_t sessionSeed() {
+        uint64_t seed;
+        if (seedFromEnvironment(seed)) {
+            return seed;
+        }
+        std::random_device device;
+        seed = (static_cast<uint64_t>(device()) << 32) | device();
+        return seed ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+private:
+    uint32_t _state[4];
+    uint64_t _seed;
+
+    static uint32_t rotl(uint32_t value, int shift) {
+        return (value << shift) | (value >> (32 - shift));
+    }
+    static uint64_t splitmix(uint64_t &state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+}
+
+#endif
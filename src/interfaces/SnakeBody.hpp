@@ -0,0 +1,120 @@
+#ifndef SNAKE_BODY_HPP_
+#define SNAKE_BODY_HPP_
+
+#include "IGraphical.hpp"
+#include "Snapshot.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace arcade {
+
+// Segments of a snake, head first, in a ring buffer allocated once for the
+// largest body the board can hold. Moving pushes a head and pops the tail
+// in place, so a long snake never allocates and stays contiguous in memory.
+// On boards too large for that bound (huge worlds) the buffer starts small
+// and doubles when a push finds it full.
+class SnakeBody {
+public:
+    SnakeBody() : _head(0), _size(0) {}
+
+    // Empties the body down to start; storage is kept when it is already
+    // large enough for capacity segments.
+    void reset(size_t capacity, const Position &start) {
+        if (_cells.size() < capacity || _cells.empty()) {
+            _cells.assign(capacity > 0 ? capacity : 1, Position());
+        }
+        _head = 0;
+        _size = 1;
+        _cells[0] = start;
+    }
+    // Empties the body down to count segments, head first, as reset() does
+    // for one.
+    void assign(size_t capacity, const Position *segments, size_t count) {
+        capacity = std::max(capacity, count);
+        if (_cells.size() < capacity || _cells.empty()) {
+            _cells.assign(capacity > 0 ? capacity : 1, Position());
+        }
+        std::copy(segments, segments + count, _cells.begin());
+        _head = 0;
+        _size = count;
+    }
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _cells.size(); }
+    bool full() const { return _size == _cells.size(); }
+
+    const Position &head() const { return _cells[_head]; }
+    const Position &tail() const { return (*this)[_size - 1]; }
+    // Segment index from the head.
+    const Position &operator[](size_t index) const {
+        size_t slot = _head + index;
+        return _cells[slot < _cells.size() ? slot : slot - _cells.size()];
+    }
+
+    void pushHead(const Position &position) {
+        if (full()) {
+            grow();
+        }
+        _head = _head == 0 ? _cells.size() - 1 : _head - 1;
+        _cells[_head] = position;
+        _size++;
+    }
+    void popTail() {
+        if (_size > 0) {
+            _size--;
+        }
+    }
+
+    // Calls fn(segments, count) for the one or two contiguous spans holding
+    // the body, head first, so it can be copied out without a loop.
+    template <typename Fn>
+    void forEachSpan(Fn &&fn) const {
+        size_t first = std::min(_size, _cells.size() - _head);
+        fn(_cells.data() + _head, first);
+        if (_size > first) {
+            fn(_cells.data(), _size - first);
+        }
+    }
+
+    // Writes the segments head first as one snapshot array, which
+    // getArray() reads back for assign().
+    void save(SnapshotWriter &out) const {
+        out.put(static_cast<uint64_t>(_size));
+        forEachSpan([&out](const Position *segments, size_t count) {
+            out.putElements(segments, count);
+        });
+    }
+
+    // Calls fn(position) from head to tail, over at most two spans.
+    template <typename Fn>
+    void forEach(Fn &&fn) const {
+        size_t first = std::min(_size, _cells.size() - _head);
+        for (size_t i = 0; i < first; i++) {
+            fn(_cells[_head + i]);
+        }
+        for (size_t i = 0; i < _size - first; i++) {
+            fn(_cells[i]);
+        }
+    }
+
+private:
+    std::vector<Position> _cells;
+    size_t _head;
+    size_t _size;
+
+    // Doubles the buffer, unrolling the segments to start at slot 0.
+    void grow() {
+        std::vector<Position> cells;
+        cells.reserve(_cells.size() * 2);
+        forEach([&cells](const Position &segment) {
+            cells.push_back(segment);
+        });
+        cells.resize(_cells.size() * 2);
+        _cells.swap(cells);
+        _head = 0;
+    }
+};
+
+}
+
+#endif
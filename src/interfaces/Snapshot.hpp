@@ -0,0 +1,123 @@
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace arcade {
+
+// Flat game snapshots (IGame::snapshot and restore). A snapshot is the
+// plugin's four-character tag and layout version followed by its fields as
+// raw bytes, arrays prefixed with their length. Only trivially copyable
+// values go in, so taking one is a handful of memcpy into a buffer the
+// caller keeps, and the bytes can be copied, stored or compared freely.
+// Snapshots live in memory for one build of the plugins, so fields are in
+// host byte order; a game bumps its version whenever its layout changes.
+class SnapshotWriter {
+public:
+    // Replaces the contents of buffer, keeping its storage.
+    SnapshotWriter(std::vector<uint8_t> &buffer, const char *tag, uint32_t version) : _buffer(buffer) {
+        _buffer.clear();
+        append(tag, 4);
+        put(version);
+    }
+
+    template <typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be trivially copyable");
+        append(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const T *values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be trivially copyable");
+        put(static_cast<uint64_t>(count));
+        append(values, count * sizeof(T));
+    }
+
+    template <typename T>
+    void putArray(const std::vector<T> &values) { putArray(values.data(), values.size()); }
+
+    // Appends values with no length, for an array written in pieces: put
+    // the total count as a uint64_t first and getArray() reads it whole.
+    template <typename T>
+    void putElements(const T *values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be trivially copyable");
+        append(values, count * sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t> &_buffer;
+
+    void append(const void *data, size_t size) {
+        size_t offset = _buffer.size();
+        _buffer.resize(offset + size);
+        if (size > 0) {
+            std::memcpy(_buffer.data() + offset, data, size);
+        }
+    }
+};
+
+// Reads a snapshot back field by field, in the order it was written. A tag
+// or version mismatch, or reading past the end, makes ok() false and every
+// later get() a no-op, so a restore reads everything into locals and
+// applies them only when complete() holds.
+class SnapshotReader {
+public:
+    SnapshotReader(const std::vector<uint8_t> &buffer, const char *tag, uint32_t version)
+        : _data(buffer.data()), _size(buffer.size()), _offset(0), _ok(true) {
+        uint32_t found = 0;
+        if (_size < 4 || std::memcmp(_data, tag, 4) != 0) {
+            _ok = false;
+            return;
+        }
+        _offset = 4;
+        _ok = get(found) && found == version;
+    }
+
+    bool ok() const { return _ok; }
+    // Everything was read and nothing is left over.
+    bool complete() const { return _ok && _offset == _size; }
+
+    template <typename T>
+    bool get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be trivially copyable");
+        return read(&value, sizeof(T));
+    }
+
+    template <typename T>
+    bool getArray(std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be trivially copyable");
+        uint64_t count = 0;
+        if (!get(count) || count > (_size - _offset) / sizeof(T)) {
+            _ok = false;
+            return false;
+        }
+        values.resize(static_cast<size_t>(count));
+        return read(values.data(), values.size() * sizeof(T));
+    }
+
+private:
+    const uint8_t *_data;
+    size_t _size;
+    size_t _offset;
+    bool _ok;
+
+    bool read(void *data, size_t size) {
+        if (!_ok || size > _size - _offset) {
+            _ok = false;
+            return false;
+        }
+        if (size > 0) {
+            std::memcpy(data, _data + _offset, size);
+        }
+        _offset += size;
+        return true;
+    }
+};
+
+}
+
+#endif
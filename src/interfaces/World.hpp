@@ -0,0 +1,408 @@
+#ifndef WORLD_HPP_
+#define WORLD_HPP_
+
+#include "IGraphical.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace arcade {
+
+// One bit per cell of a board too large to hold densely, in 64 x 64 chunks
+// (one word per chunk row). A chunk is allocated by the first bit set in it
+// and freed when its last bit clears, so memory follows what the layer
+// holds rather than the board size; cells in missing chunks read as clear.
+class ChunkedLayer {
+public:
+    static constexpr int CHUNK_SHIFT = 6;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+    ChunkedLayer() : _width(0), _height(0), _columns(0), _allocated(0) {}
+
+    void resize(int width, int height) {
+        _width = width > 0 ? width : 0;
+        _height = height > 0 ? height : 0;
+        _columns = (_width + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+        _chunks.clear();
+        _chunks.resize(static_cast<size_t>(_columns) * ((_height + CHUNK_SIZE - 1) >> CHUNK_SHIFT));
+        _allocated = 0;
+    }
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    bool inBounds(int x, int y) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(_width)
+            && static_cast<unsigned>(y) < static_cast<unsigned>(_height);
+    }
+
+    bool test(int x, int y) const {
+        if (!inBounds(x, y)) {
+            return false;
+        }
+        const Chunk *chunk = _chunks[chunkIndex(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)].get();
+        return chunk && ((chunk->rows[y & (CHUNK_SIZE - 1)] >> (x & 63)) & 1);
+    }
+    void set(int x, int y) {
+        if (!inBounds(x, y)) {
+            return;
+        }
+        std::unique_ptr<Chunk> &chunk = _chunks[chunkIndex(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)];
+        if (!chunk) {
+            chunk.reset(new Chunk());
+            _allocated++;
+        }
+        uint64_t &row = chunk->rows[y & (CHUNK_SIZE - 1)];
+        if (!(row & bit(x))) {
+            row |= bit(x);
+            chunk->count++;
+        }
+    }
+    void reset(int x, int y) {
+        if (!inBounds(x, y)) {
+            return;
+        }
+        std::unique_ptr<Chunk> &chunk = _chunks[chunkIndex(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)];
+        if (!chunk) {
+            return;
+        }
+        uint64_t &row = chunk->rows[y & (CHUNK_SIZE - 1)];
+        if (row & bit(x)) {
+            row &= ~bit(x);
+            if (--chunk->count == 0) {
+                chunk.reset();
+                _allocated--;
+            }
+        }
+    }
+    void clear() {
+        for (auto &chunk : _chunks) {
+            chunk.reset();
+        }
+        _allocated = 0;
+    }
+
+    // Replaces a whole chunk; one left with no bit set is not stored.
+    void assignChunk(int chunkX, int chunkY, const uint64_t (&rows)[CHUNK_SIZE]) {
+        dropChunk(chunkX, chunkY);
+        int count = 0;
+        for (uint64_t row : rows) {
+            count += __builtin_popcountll(row);
+        }
+        if (count == 0) {
+            return;
+        }
+        std::unique_ptr<Chunk> &chunk = _chunks[chunkIndex(chunkX, chunkY)];
+        chunk.reset(new Chunk());
+        std::copy(rows, rows + CHUNK_SIZE, chunk->rows);
+        chunk->count = count;
+        _allocated++;
+    }
+    void dropChunk(int chunkX, int chunkY) {
+        std::unique_ptr<Chunk> &chunk = _chunks[chunkIndex(chunkX, chunkY)];
+        if (chunk) {
+            chunk.reset();
+            _allocated--;
+        }
+    }
+
+    size_t chunkCount() const { return _allocated; }
+    size_t memoryBytes() const {
+        return _allocated * sizeof(Chunk) + _chunks.size() * sizeof(_chunks[0]);
+    }
+
+    // Calls fn(x, y) for every set cell of the rectangle, chunk by chunk;
+    // only the chunks it overlaps are looked at and missing ones are
+    // skipped whole, so the cost follows the rectangle, not the board.
+    template <typename Fn>
+    void forEachIn(int left, int top, int width, int height, Fn &&fn) const {
+        int right = std::min(left + width, _width);
+        int bottom = std::min(top + height, _height);
+        left = std::max(left, 0);
+        top = std::max(top, 0);
+        if (left >= right || top >= bottom) {
+            return;
+        }
+        for (int chunkY = top >> CHUNK_SHIFT; chunkY <= (bottom - 1) >> CHUNK_SHIFT; chunkY++) {
+            for (int chunkX = left >> CHUNK_SHIFT; chunkX <= (right - 1) >> CHUNK_SHIFT; chunkX++) {
+                const Chunk *chunk = _chunks[chunkIndex(chunkX, chunkY)].get();
+                if (!chunk) {
+                    continue;
+                }
+                int baseX = chunkX << CHUNK_SHIFT;
+                int baseY = chunkY << CHUNK_SHIFT;
+                uint64_t mask = columnMask(left - baseX, right - baseX);
+                int last = std::min(bottom - baseY, CHUNK_SIZE);
+                for (int row = std::max(top - baseY, 0); row < last; row++) {
+                    uint64_t w = chunk->rows[row] & mask;
+                    while (w) {
+                        fn(baseX + __builtin_ctzll(w), baseY + row);
+                        w &= w - 1;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Chunk {
+        uint64_t rows[CHUNK_SIZE] = {};
+        int count = 0;
+    };
+
+    int _width;
+    int _height;
+    int _columns;
+    size_t _allocated;
+    std::vector<std::unique_ptr<Chunk>> _chunks;
+
+    static uint64_t bit(int x) { return uint64_t(1) << (x & 63); }
+    size_t chunkIndex(int chunkX, int chunkY) const {
+        return static_cast<size_t>(chunkY) * _columns + chunkX;
+    }
+    // Bits from..to-1 of a chunk row, clamped to the chunk.
+    static uint64_t columnMask(int from, int to) {
+        from = std::max(from, 0);
+        to = std::min(to, CHUNK_SIZE);
+        if (from >= to) {
+            return 0;
+        }
+        uint64_t below = to == CHUNK_SIZE ? ~uint64_t(0) : (uint64_t(1) << to) - 1;
+        return below & ~((uint64_t(1) << from) - 1);
+    }
+};
+
+// The huge-world board of Snake and Nibbler, up to MAX_SIDE cells a side.
+// Walls are a border plus obstacles scattered by a hash of the seed and the
+// cell, so they need no storage: the chunks around the camera are
+// generated into a ChunkedLayer for fast drawing and collision, and
+// dropped again once the camera moves on. Bodies and items are chunked
+// layers of their own. The camera keeps the focus (the head) centred in a
+// VIEW_WIDTH x VIEW_HEIGHT window, and drawing only walks the chunks that
+// window overlaps, so memory and frame time follow the visible area.
+class World {
+public:
+    static constexpr int MAX_SIDE = 4096;
+    // What an 800 x 600 window shows at 20-pixel cells.
+    static constexpr int VIEW_WIDTH = 40;
+    static constexpr int VIEW_HEIGHT = 30;
+    // Obstacles keep this far from the start so a game never opens on one.
+    static constexpr int SAFE_RADIUS = 8;
+    // Segments a snake reserves before its SnakeBody starts doubling.
+    static constexpr size_t BODY_CAPACITY = 1024;
+
+    // The size asked for with ARCADE_WORLD_SIZE, as "N" for N x N or
+    // "WxH"; false when unset or unusable, for the regular board.
+    static bool sizeFromEnvironment(int &width, int &height) {
+        const char *size = std::getenv("ARCADE_WORLD_SIZE");
+        if (!size) {
+            return false;
+        }
+        char *end = nullptr;
+        long w = std::strtol(size, &end, 10);
+        long h = w;
+        if (*end == 'x' || *end == 'X') {
+            h = std::strtol(end + 1, &end, 10);
+        }
+        if (*end != '\0' || w < 3 || h < 3) {
+            return false;
+        }
+        width = static_cast<int>(std::min<long>(w, MAX_SIDE));
+        height = static_cast<int>(std::min<long>(h, MAX_SIDE));
+        return true;
+    }
+
+    // obstacles is the share of cells walled, in 1024ths.
+    World(int width, int height, uint32_t seed, int obstacles, const Position &start)
+        : _width(width), _height(height), _seed(seed), _obstacles(obstacles), _start(start),
+          _viewLeft(0), _viewTop(0), _peakChunks(0), _frames(0), _frameSeconds(0) {
+        _walls.resize(width, height);
+        _bodies.resize(width, height);
+        _items.resize(width, height);
+        _cached.assign(static_cast<size_t>(chunkColumns()) * chunkRows(), false);
+        follow(start);
+    }
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    uint32_t getSeed() const { return _seed; }
+    const Position &getStart() const { return _start; }
+    bool inBounds(int x, int y) const { return _walls.inBounds(x, y); }
+
+    bool isWall(int x, int y) const {
+        if (!inBounds(x, y)) {
+            return true;
+        }
+        if (_cached[chunkIndex(x >> ChunkedLayer::CHUNK_SHIFT, y >> ChunkedLayer::CHUNK_SHIFT)]) {
+            return _walls.test(x, y);
+        }
+        return generateWall(x, y);
+    }
+    bool isBlocked(int x, int y) const { return isWall(x, y) || _bodies.test(x, y); }
+    bool hasItem(int x, int y) const { return _items.test(x, y); }
+
+    const ChunkedLayer &walls() const { return _walls; }
+    ChunkedLayer &bodies() { return _bodies; }
+    const ChunkedLayer &bodies() const { return _bodies; }
+    ChunkedLayer &items() { return _items; }
+    const ChunkedLayer &items() const { return _items; }
+
+    // Centres the view on focus, clamped to the world, then generates the
+    // wall chunks within one chunk of it and drops the others.
+    void follow(const Position &focus) {
+        _viewLeft = std::max(0, std::min(focus.x - viewWidth() / 2, _width - viewWidth()));
+        _viewTop = std::max(0, std::min(focus.y - viewHeight() / 2, _height - viewHeight()));
+
+        int firstX = std::max((_viewLeft >> ChunkedLayer::CHUNK_SHIFT) - 1, 0);
+        int firstY = std::max((_viewTop >> ChunkedLayer::CHUNK_SHIFT) - 1, 0);
+        int lastX = std::min(((_viewLeft + viewWidth() - 1) >> ChunkedLayer::CHUNK_SHIFT) + 1, chunkColumns() - 1);
+        int lastY = std::min(((_viewTop + viewHeight() - 1) >> ChunkedLayer::CHUNK_SHIFT) + 1, chunkRows() - 1);
+        size_t kept = 0;
+        for (size_t i = 0; i < _cachedList.size(); i++) {
+            int chunkX = static_cast<int>(_cachedList[i] % chunkColumns());
+            int chunkY = static_cast<int>(_cachedList[i] / chunkColumns());
+            if (chunkX < firstX || chunkX > lastX || chunkY < firstY || chunkY > lastY) {
+                _walls.dropChunk(chunkX, chunkY);
+                _cached[_cachedList[i]] = false;
+            } else {
+                _cachedList[kept++] = _cachedList[i];
+            }
+        }
+        _cachedList.resize(kept);
+        for (int chunkY = firstY; chunkY <= lastY; chunkY++) {
+            for (int chunkX = firstX; chunkX <= lastX; chunkX++) {
+                if (!_cached[chunkIndex(chunkX, chunkY)]) {
+                    generateChunk(chunkX, chunkY);
+                }
+            }
+        }
+        _peakChunks = std::max(_peakChunks, chunkCount());
+    }
+
+    int viewLeft() const { return _viewLeft; }
+    int viewTop() const { return _viewTop; }
+    int viewWidth() const { return std::min(VIEW_WIDTH, _width); }
+    int viewHeight() const { return std::min(VIEW_HEIGHT, _height); }
+    bool inView(int x, int y) const {
+        return x >= _viewLeft && x < _viewLeft + viewWidth() && y >= _viewTop && y < _viewTop + viewHeight();
+    }
+
+    // Calls fn(x, y) with view-relative coordinates for each set cell of
+    // layer inside the view.
+    template <typename Fn>
+    void forEachVisible(const ChunkedLayer &layer, Fn &&fn) const {
+        layer.forEachIn(_viewLeft, _viewTop, viewWidth(), viewHeight(), [&](int x, int y) {
+            fn(x - _viewLeft, y - _viewTop);
+        });
+    }
+
+    // A cell of the view holding no wall, body or item, tried at random
+    // with numbers from random() (a game's Random) before the view is
+    // scanned; false when the view has none.
+    template <typename Generator>
+    bool sampleFree(Generator &&random, int &x, int &y) const {
+        for (int attempt = 0; attempt < 64; attempt++) {
+            x = _viewLeft + static_cast<int>(static_cast<unsigned>(random()) % viewWidth());
+            y = _viewTop + static_cast<int>(static_cast<unsigned>(random()) % viewHeight());
+            if (!isBlocked(x, y) && !hasItem(x, y)) {
+                return true;
+            }
+        }
+        for (y = _viewTop; y < _viewTop + viewHeight(); y++) {
+            for (x = _viewLeft; x < _viewLeft + viewWidth(); x++) {
+                if (!isBlocked(x, y) && !hasItem(x, y)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    size_t chunkCount() const {
+        return _walls.chunkCount() + _bodies.chunkCount() + _items.chunkCount();
+    }
+    size_t memoryBytes() const {
+        return _walls.memoryBytes() + _bodies.memoryBytes() + _items.memoryBytes() + _cached.size() / 8;
+    }
+
+    void addFrame(double seconds) {
+        _frames++;
+        _frameSeconds += seconds;
+    }
+    void report(std::ostream &out, const std::string &game) const {
+        if (_frames == 0) {
+            return;
+        }
+        out << game << ": world " << _width << "x" << _height << ", " << _frames << " frames drawn at "
+            << (_frameSeconds / _frames * 1e6) << " us, " << chunkCount() << " chunks ("
+            << memoryBytes() / 1024 << " KiB), peak " << _peakChunks << " chunks" << std::endl;
+    }
+
+private:
+    int _width;
+    int _height;
+    uint32_t _seed;
+    int _obstacles;
+    Position _start;
+    ChunkedLayer _walls;
+    ChunkedLayer _bodies;
+    ChunkedLayer _items;
+    // Wall chunks currently generated, as a flag per chunk and a list.
+    std::vector<bool> _cached;
+    std::vector<size_t> _cachedList;
+    int _viewLeft;
+    int _viewTop;
+    size_t _peakChunks;
+    size_t _frames;
+    double _frameSeconds;
+
+    int chunkColumns() const { return (_width + ChunkedLayer::CHUNK_SIZE - 1) >> ChunkedLayer::CHUNK_SHIFT; }
+    int chunkRows() const { return (_height + ChunkedLayer::CHUNK_SIZE - 1) >> ChunkedLayer::CHUNK_SHIFT; }
+    size_t chunkIndex(int chunkX, int chunkY) const {
+        return static_cast<size_t>(chunkY) * chunkColumns() + chunkX;
+    }
+
+    bool generateWall(int x, int y) const {
+        if (x == 0 || y == 0 || x == _width - 1 || y == _height - 1) {
+            return true;
+        }
+        if (_obstacles <= 0 || (std::abs(x - _start.x) <= SAFE_RADIUS && std::abs(y - _start.y) <= SAFE_RADIUS)) {
+            return false;
+        }
+        uint32_t h = _seed ^ (static_cast<uint32_t>(x) * 0x9E3779B1u) ^ (static_cast<uint32_t>(y) * 0x85EBCA77u);
+        h ^= h >> 16;
+        h *= 0x7FEB352Du;
+        h ^= h >> 15;
+        h *= 0x846CA68Bu;
+        h ^= h >> 16;
+        return static_cast<int>(h & 1023) < _obstacles;
+    }
+
+    void generateChunk(int chunkX, int chunkY) {
+        uint64_t rows[ChunkedLayer::CHUNK_SIZE] = {};
+        int baseX = chunkX << ChunkedLayer::CHUNK_SHIFT;
+        int baseY = chunkY << ChunkedLayer::CHUNK_SHIFT;
+        bool edge = baseX == 0 || baseY == 0 || baseX + ChunkedLayer::CHUNK_SIZE >= _width
+                 || baseY + ChunkedLayer::CHUNK_SIZE >= _height;
+        // Inner chunks of an obstacle-free world hold nothing.
+        if (edge || _obstacles > 0) {
+            for (int row = 0; row < ChunkedLayer::CHUNK_SIZE && baseY + row < _height; row++) {
+                for (int column = 0; column < ChunkedLayer::CHUNK_SIZE && baseX + column < _width; column++) {
+                    if (generateWall(baseX + column, baseY + row)) {
+                        rows[row] |= uint64_t(1) << column;
+                    }
+                }
+            }
+        }
+        _walls.assignChunk(chunkX, chunkY, rows);
+        _cached[chunkIndex(chunkX, chunkY)] = true;
+        _cachedList.push_back(chunkIndex(chunkX, chunkY));
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+** EPITECH PROJECT, 2025
+** add
+** File description:
+** arcade_mapc
+*/
+
+#include "../interfaces/MapLoader.hpp"
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+void displayUsage(const std::string &programName) {
+    std::cout << "USAGE: " << programName << " map.txt..." << std::endl;
+    std::cout << "       map.txt: Text map to compile; map.amap is written next to it" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        displayUsage(argv[0]);
+        return 84;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::string source = argv[i];
+        std::string target = arcade::MapLoader::compiledPath(source);
+        try {
+            arcade::CompiledMap map = arcade::CompiledMap::fromText(arcade::MapLoader::loadMap(source));
+            std::vector<uint8_t> data = map.encode();
+            // Decode what was produced so a broken file is never installed.
+            arcade::CompiledMap::decode(data.data(), data.size());
+
+            std::string temporary = target + ".tmp";
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(data.data()), data.size());
+            file.close();
+            if (!file || std::rename(temporary.c_str(), target.c_str()) != 0) {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("Cannot write " + target);
+            }
+            std::cout << source << " -> " << target << ": " << map.width << "x" << map.height << ", "
+                      << map.wallCells.size() << " walls, " << map.dots.count() << " dots, "
+                      << map.markers.size() << " markers, " << data.size() << " bytes" << std::endl;
+        } catch (const std::exception &e) {
+            std::cerr << "Error: " << source << ": " << e.what() << std::endl;
+            return 84;
+        }
+    }
+    return 0;
+}
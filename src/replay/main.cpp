@@ -0,0 +1,87 @@
+/*
+** EPITECH PROJECT, 2025
+** add
+** File description:
+** arcade_replay
+*/
+
+#include "../core/DLLoader.hpp"
+#include "../interfaces/IGraphical.hpp"
+#include "../interfaces/IGame.hpp"
+#include "../interfaces/DrawLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+void displayUsage(const std::string &programName) {
+    std::cout << "USAGE: " << programName << " draw_log path_to_graphical_lib" << std::endl;
+    std::cout << "       draw_log: Log recorded by arcade_null.so (ARCADE_NULL_RECORD)" << std::endl;
+    std::cout << "       path_to_graphical_lib: Backend to replay the frames on" << std::endl;
+}
+
+double percentile(const std::vector<double> &sorted, double ratio) {
+    size_t index = static_cast<size_t>(ratio * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        displayUsage(argv[0]);
+        return 84;
+    }
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open draw log: " << argv[1] << std::endl;
+        return 84;
+    }
+    std::vector<uint8_t> log((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    try {
+        arcade::DrawLogReader reader(log.data(), log.size());
+        arcade::DLLoader<arcade::IGraphical> loader(argv[2]);
+        auto graphical = loader.getInstance();
+
+        reader.readInit();
+        graphical->init(reader.getWidth(), reader.getHeight(), "Arcade Replay");
+        std::vector<double> frameTimes;
+        auto start = std::chrono::steady_clock::now();
+        while (graphical->isOpen()) {
+            auto frameStart = std::chrono::steady_clock::now();
+            if (!reader.playFrame(*graphical)) {
+                break;
+            }
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - frameStart).count());
+            if (graphical->getEvent() == arcade::EventType::QUIT) {
+                break;
+            }
+        }
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::string name = graphical->getName();
+        if (graphical->isOpen()) {
+            graphical->close();
+        }
+
+        if (frameTimes.empty()) {
+            std::cerr << "Error: Draw log holds no complete frame" << std::endl;
+            return 84;
+        }
+        std::sort(frameTimes.begin(), frameTimes.end());
+        std::cout << name << ": " << frameTimes.size() << " frames in " << total << " s" << std::endl;
+        std::cout << "  frame ms: p50 " << percentile(frameTimes, 0.5)
+                  << ", p95 " << percentile(frameTimes, 0.95)
+                  << ", p99 " << percentile(frameTimes, 0.99)
+                  << ", max " << frameTimes.back() << std::endl;
+        // These two still cap their frame rate inside display().
+        if (name == "SDL2" || name == "SFML") {
+            std::cout << "  (includes " << name << "'s own 60 fps frame pacing in display())" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+** EPITECH PROJECT, 2025
+** add
+** File description:
+** arcade_sim
+*/
+
+#include "../core/DLLoader.hpp"
+#include "../interfaces/IGraphical.hpp"
+#include "../interfaces/IGame.hpp"
+#include "../interfaces/EventScript.hpp"
+#include "../interfaces/Random.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+void displayUsage(const std::string &programName) {
+    std::cout << "USAGE: " << programName << " path_to_game_lib [options]" << std::endl;
+    std::cout << "       path_to_game_lib: Game library (.so file) to run headless" << std::endl;
+    std::cout << "       --ticks N: Number of ticks to run (default 100000)" << std::endl;
+    std::cout << "       --dt S: Seconds per tick (default 1/60)" << std::endl;
+    std::cout << "       --seed N: Seed of the game and of the random input (default 1)" << std::endl;
+    std::cout << "       --script EVENTS: Scripted input, e.g. \"1:MOVE_UP,60:MOVE_LEFT\"" << std::endl;
+    std::cout << "       --turn N: Random input turns every N ticks on average (default 8)" << std::endl;
+    std::cout << "       --render LIB: Render every tick into a graphical library" << std::endl;
+    std::cout << "                     (./lib/arcade_null.so counts the draw calls)" << std::endl;
+    std::cout << "       --min-tps N: Fail unless at least N ticks per second are reached" << std::endl;
+}
+
+double percentile(const std::vector<double> &sorted, double ratio) {
+    size_t index = static_cast<size_t>(ratio * (sorted.size() - 1));
+    return sorted[index];
+}
+
+struct Options {
+    std::string game;
+    size_t ticks = 100000;
+    float deltaTime = 1.0f / 60.0f;
+    std::string seed = "1";
+    std::string script;
+    unsigned turn = 8;
+    std::string render;
+    double minTicksPerSecond = 0;
+};
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.game = argv[1];
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (option == "--ticks") {
+            options.ticks = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (option == "--dt") {
+            options.deltaTime = std::strtof(value.c_str(), nullptr);
+        } else if (option == "--seed") {
+            options.seed = value;
+        } else if (option == "--script") {
+            options.script = value;
+        } else if (option == "--turn") {
+            options.turn = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (option == "--render") {
+            options.render = value;
+        } else if (option == "--min-tps") {
+            options.minTicksPerSecond = std::strtod(value.c_str(), nullptr);
+        } else {
+            return false;
+        }
+    }
+    return options.ticks > 0 && options.deltaTime > 0 && options.turn > 0;
+}
+
+// Input for one tick: the script when there is one, otherwise a random
+// direction now and then, drawn from the run's seed.
+class InputPolicy {
+public:
+    InputPolicy(const Options &options, uint64_t seed)
+        : _random(seed), _turn(options.turn), _next(0) {
+        if (!options.script.empty()) {
+            _script = arcade::parseEventScript(options.script);
+            _scripted = true;
+        }
+    }
+
+    arcade::EventType next(size_t tick) {
+        if (_scripted) {
+            if (_next < _script.size() && _script[_next].first <= tick) {
+                return _script[_next++].second;
+            }
+            return arcade::EventType::NONE;
+        }
+        static const arcade::EventType directions[] = {
+            arcade::EventType::MOVE_UP, arcade::EventType::MOVE_DOWN,
+            arcade::EventType::MOVE_LEFT, arcade::EventType::MOVE_RIGHT
+        };
+        if (_random.below(_turn) != 0) {
+            return arcade::EventType::NONE;
+        }
+        return directions[_random.below(4)];
+    }
+
+private:
+    arcade::Random _random;
+    arcade::EventScript _script;
+    bool _scripted = false;
+    unsigned _turn;
+    size_t _next;
+};
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        displayUsage(argv[0]);
+        return 84;
+    }
+    // The game seeds itself from ARCADE_SEED, like under the core.
+    uint64_t seed = 0;
+    setenv("ARCADE_SEED", options.seed.c_str(), 1);
+    if (!arcade::Random::seedFromEnvironment(seed)) {
+        std::cerr << "Error: invalid seed: " << options.seed << std::endl;
+        return 84;
+    }
+
+    try {
+        InputPolicy input(options, seed);
+        std::unique_ptr<arcade::DLLoader<arcade::IGraphical>> graphicalLoader;
+        std::shared_ptr<arcade::IGraphical> graphical;
+        if (!options.render.empty()) {
+            graphicalLoader = std::make_unique<arcade::DLLoader<arcade::IGraphical>>(options.render);
+            graphical = graphicalLoader->getInstance();
+            graphical->init(800, 600, "Arcade Sim");
+        }
+        arcade::DLLoader<arcade::IGame> loader(options.game);
+        auto game = loader.getInstance();
+
+        game->init();
+        game->setState(arcade::GameState::PLAYING);
+        std::vector<uint8_t> start;
+        game->snapshot(start);
+
+        std::vector<double> tickTimes;
+        tickTimes.reserve(options.ticks);
+        size_t games = 1;
+        int bestScore = 0;
+        auto runStart = std::chrono::steady_clock::now();
+        for (size_t tick = 1; tick <= options.ticks; tick++) {
+            auto tickStart = std::chrono::steady_clock::now();
+            arcade::EventType event = input.next(tick);
+            if (event == arcade::EventType::PAUSE) {
+                game->setState(game->getState() == arcade::GameState::PLAYING
+                    ? arcade::GameState::PAUSED : arcade::GameState::PLAYING);
+            } else if (event != arcade::EventType::NONE) {
+                game->handleEvent(event);
+            }
+            game->update(options.deltaTime);
+            if (graphical) {
+                game->render(*graphical);
+            }
+            // A finished game starts over from its first tick, the way
+            // restarting it under the core does.
+            arcade::GameState state = game->getState();
+            if (state == arcade::GameState::GAME_OVER || state == arcade::GameState::WIN) {
+                bestScore = std::max(bestScore, game->getScore());
+                if (!game->restore(start)) {
+                    game->restart();
+                }
+                game->setState(arcade::GameState::PLAYING);
+                games++;
+            }
+            tickTimes.push_back(std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - tickStart).count());
+        }
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+        int score = game->getScore();
+        bestScore = std::max(bestScore, score);
+        std::string name = game->getName();
+        game->stop();
+        if (graphical && graphical->isOpen()) {
+            graphical->close();
+        }
+
+        double ticksPerSecond = total > 0 ? tickTimes.size() / total : 0;
+        std::sort(tickTimes.begin(), tickTimes.end());
+        std::cout << name << ": " << tickTimes.size() << " ticks in " << total << " s, "
+                  << ticksPerSecond << " ticks/s" << std::endl;
+        std::cout << "  tick us: p50 " << percentile(tickTimes, 0.5)
+                  << ", p95 " << percentile(tickTimes, 0.95)
+                  << ", p99 " << percentile(tickTimes, 0.99)
+                  << ", max " << tickTimes.back() << std::endl;
+        std::cout << "  score " << score << ", best " << bestScore << " over " << games << " games" << std::endl;
+        if (ticksPerSecond < options.minTicksPerSecond) {
+            std::cerr << "Error: " << ticksPerSecond << " ticks/s is below the required "
+                      << options.minTicksPerSecond << std::endl;
+            return 84;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}
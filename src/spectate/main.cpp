@@ -0,0 +1,118 @@
+/*
+** EPITECH PROJECT, 2025
+** add
+** File description:
+** arcade_spectate
+*/
+
+#include "../core/DLLoader.hpp"
+#include "../interfaces/IGraphical.hpp"
+#include "../interfaces/IGame.hpp"
+#include "../interfaces/DrawLog.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+void displayUsage(const std::string &programName) {
+    std::cout << "USAGE: " << programName << " socket_path path_to_graphical_lib" << std::endl;
+    std::cout << "       socket_path: Socket given to arcade through ARCADE_SPECTATOR" << std::endl;
+    std::cout << "       path_to_graphical_lib: Backend to watch the game on" << std::endl;
+}
+
+int connectTo(const std::string &path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        std::string error = std::strerror(errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Cannot connect to " + path + ": " + error);
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        displayUsage(argv[0]);
+        return 84;
+    }
+
+    int fd = -1;
+    try {
+        fd = connectTo(argv[1]);
+        arcade::DLLoader<arcade::IGraphical> loader(argv[2]);
+        auto graphical = loader.getInstance();
+        std::unique_ptr<arcade::DrawLogReader> reader;
+        std::vector<uint8_t> buffer;
+        size_t frames = 0;
+        size_t received = 0;
+        bool connected = true;
+
+        while (connected && (!reader || graphical->isOpen())) {
+            pollfd request = {fd, POLLIN, 0};
+            if (poll(&request, 1, 16) > 0) {
+                uint8_t chunk[65536];
+                ssize_t count = read(fd, chunk, sizeof(chunk));
+                if (count <= 0) {
+                    connected = false;
+                } else {
+                    buffer.insert(buffer.end(), chunk, chunk + count);
+                    received += count;
+                }
+            }
+
+            // Messages are a 32-bit little-endian length, then DrawLog bytes.
+            size_t offset = 0;
+            while (buffer.size() - offset >= 4) {
+                uint32_t size = buffer[offset] | (buffer[offset + 1] << 8) | (buffer[offset + 2] << 16)
+                              | (static_cast<uint32_t>(buffer[offset + 3]) << 24);
+                if (buffer.size() - offset - 4 < size) {
+                    break;
+                }
+                const uint8_t *message = buffer.data() + offset + 4;
+                offset += 4 + size;
+                if (!reader) {
+                    reader = std::make_unique<arcade::DrawLogReader>(message, size);
+                    reader->readInit();
+                    graphical->init(reader->getWidth(), reader->getHeight(), "Arcade Spectator");
+                    continue;
+                }
+                reader->setInput(message, size);
+                if (reader->playFrame(*graphical)) {
+                    frames++;
+                }
+            }
+            buffer.erase(buffer.begin(), buffer.begin() + offset);
+
+            if (reader && graphical->getEvent() == arcade::EventType::QUIT) {
+                break;
+            }
+        }
+        close(fd);
+        if (graphical->isOpen()) {
+            graphical->close();
+        }
+        std::cout << "Spectator: " << frames << " frames, "
+                  << (frames ? received / frames : 0) << " bytes/frame received" << std::endl;
+    } catch (const std::exception &e) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 84;
+    }
+    return 0;
+}